@@ -0,0 +1,101 @@
+
+#ifndef INCLUDED_PATTON_ALGORITHM_HPP_
+#define INCLUDED_PATTON_ALGORITHM_HPP_
+
+
+#include <span>
+#include <cstddef>      // for size_t
+#include <type_traits>  // for remove_const<>
+
+#include <gsl-lite/gsl-lite.hpp>  // for gsl_Expects(), gsl_FailFast()
+
+#include <patton/thread_squad.hpp>
+
+#include <patton/detail/algorithm.hpp>
+
+
+namespace patton {
+
+
+    //
+    // Reduction operations supported by `parallel_reduce()`.
+    //
+enum class reduce_op
+{
+        //
+        // The sum of all elements. Integer sums wrap around on overflow.
+        //
+    sum,
+
+        //
+        // The smallest element, or the largest representable value (∞ for floating-point types) if the range is empty.
+        //
+    min,
+
+        //
+        // The largest element, or the smallest representable value (-∞ for floating-point types) if the range is empty.
+        //
+    max
+};
+
+
+    //
+    // Reduces the elements of `data` with the reduction operation `op` on `concurrency` threads of the thread squad.
+    //ᅟ
+    // Every thread reduces a contiguous block of elements with a vectorized kernel that uses multiple accumulators and that is
+    // selected at runtime for the instruction set supported by the processor. The partial results are then merged along the
+    // reduction tree used by `thread_squad::transform_reduce()`. Small ranges are reduced by fewer threads.
+    //ᅟ
+    // The element type must be one of `float`, `double`, `std::int32_t`, or `std::int64_t`. Because floating-point sums are
+    // reassociated, the result may differ from the result of a sequential summation. If `data` contains NaN values, the result
+    // of `reduce_op::min` and `reduce_op::max` is unspecified.
+    // `concurrency` must not exceed the number of threads in the thread squad. A value of -1 indicates that all available
+    // threads shall be used.
+    //
+template <typename T, std::size_t Extent>
+requires detail::simd_arithmetic<std::remove_const_t<T>>
+[[nodiscard]] std::remove_const_t<T>
+parallel_reduce(thread_squad& threadSquad, std::span<T, Extent> data, reduce_op op, int concurrency = -1)
+{
+    gsl_Expects(concurrency >= -1 && concurrency <= threadSquad.num_threads());
+
+    using V = std::remove_const_t<T>;
+    V const* ptr = data.data();
+    switch (op)
+    {
+    case reduce_op::sum:
+        return detail::parallel_reduce(threadSquad, detail::sum_reduction{ }, concurrency, data.size(), ptr);
+    case reduce_op::min:
+        return detail::parallel_reduce(threadSquad, detail::min_reduction{ }, concurrency, data.size(), ptr);
+    case reduce_op::max:
+        return detail::parallel_reduce(threadSquad, detail::max_reduction{ }, concurrency, data.size(), ptr);
+    }
+    gsl_FailFast();
+}
+
+    //
+    // Computes the dot product of `x` and `y` on `concurrency` threads of the thread squad.
+    //ᅟ
+    // Uses the same vectorized kernels and partitioning as `parallel_reduce()`. `x` and `y` must have the same size. Because
+    // floating-point sums are reassociated, the result may differ from the result of a sequential computation. Integer
+    // arithmetic wraps around on overflow.
+    // `concurrency` must not exceed the number of threads in the thread squad. A value of -1 indicates that all available
+    // threads shall be used.
+    //
+template <typename T, std::size_t ExtentX, typename U, std::size_t ExtentY>
+requires detail::simd_arithmetic<std::remove_const_t<T>> && std::same_as<std::remove_const_t<T>, std::remove_const_t<U>>
+[[nodiscard]] std::remove_const_t<T>
+parallel_dot(thread_squad& threadSquad, std::span<T, ExtentX> x, std::span<U, ExtentY> y, int concurrency = -1)
+{
+    gsl_Expects(x.size() == y.size());
+    gsl_Expects(concurrency >= -1 && concurrency <= threadSquad.num_threads());
+
+    using V = std::remove_const_t<T>;
+    return detail::parallel_reduce(threadSquad, detail::dot_reduction{ }, concurrency, x.size(), static_cast<V const*>(x.data()), static_cast<V const*>(y.data()));
+}
+
+
+} // namespace patton
+
+
+#endif // INCLUDED_PATTON_ALGORITHM_HPP_
@@ -5,15 +5,24 @@
 
 #include <new>           // for bad_alloc
 #include <span>
+#include <array>
+#include <tuple>
 #include <memory>        // for unique_ptr<>, allocator_traits<>
+#include <algorithm>     // for max()
 #include <cstddef>       // for size_t, ptrdiff_t
-#include <utility>       // for move(), forward<>(), exchange(), in_place
+#include <limits>
+#include <utility>       // for move(), forward<>(), exchange(), in_place, move_if_noexcept(), index_sequence<>
 #include <type_traits>   // for is_const<>, is_volatile<>, is_reference<>, is_nothrow_constructible<>, enable_if<>, negation<>
 #include <system_error>  // for errc
+#if __has_include(<mdspan>)
+# include <mdspan>
+#endif
 
 #include <gsl-lite/gsl-lite.hpp>  // for gsl_Expects(), owner<>
 
-#include <patton/memory.hpp>  // for aligned_allocator<>, aligned_allocator_adaptor<>
+#include <patton/new.hpp>           // for hardware_page_size()
+#include <patton/memory.hpp>        // for aligned_allocator<>, aligned_allocator_adaptor<>
+#include <patton/thread_squad.hpp>  // for thread_squad
 
 #include <patton/detail/buffer.hpp>
 #include <patton/detail/arithmetic.hpp>   // for try_multiply_unsigned(), try_ceili()
@@ -92,6 +101,46 @@ private:
             transaction.commit();
         }
     }
+    template <typename... Ts>
+    aligned_buffer(internal_constructor, thread_squad& threadSquad, thread_squad::schedule sched, std::size_t _size, allocator_type _allocator, Ts const&... args)
+        : allocator_type(std::move(_allocator)), size_(_size), bytesPerElement_(computeBytesPerElement())
+    {
+        static_assert(std::is_nothrow_constructible_v<T, Ts const&...>, "elements constructed by a thread squad must be nothrow-constructible");
+
+        if (_size == 0)
+        {
+            data_ = nullptr;
+        }
+        else
+        {
+            auto numBytesR = detail::try_multiply_unsigned(_size, bytesPerElement_);
+            if (numBytesR.ec != std::errc{ }) throw std::bad_alloc{ };
+            std::size_t numBytes = numBytesR.value;
+
+            auto alloc = byte_allocator_(get_allocator());
+            data_ = std::allocator_traits<byte_allocator_>::allocate(alloc, numBytes);
+
+                // Every element is constructed by the thread which processes its index, so with a first-touch page placement
+                // policy, memory pages are placed on the NUMA node of that thread. Because construction may be a no-op (e.g.
+                // for `default_init_allocator<>`), the thread also explicitly faults in every page that begins within the
+                // element, which moves the cost of page faults out of the first pass over the data.
+            auto lalloc = get_allocator();
+            std::size_t pageSize = hardware_page_size();
+            threadSquad.for_each_index(0, std::ptrdiff_t(_size),
+                [lalloc, data = data_, bytesPerElement = bytesPerElement_, pageSize, &args...]
+                (std::ptrdiff_t i) mutable
+                {
+                    char* element = &data[std::size_t(i) * bytesPerElement];
+                    if (i == 0)
+                    {
+                        *reinterpret_cast<char volatile*>(element) = 0;  // the buffer need not begin on a page boundary
+                    }
+                    detail::first_touch_pages(element, bytesPerElement, pageSize);
+                    std::allocator_traits<allocator_type>::construct(lalloc, reinterpret_cast<T*>(element), args...);
+                },
+                sched);
+        }
+    }
     void
     destroy_and_free() noexcept
     {
@@ -149,6 +198,33 @@ public:
     explicit aligned_buffer(std::size_t _size, A _alloc, std::in_place_t, Ts&&... _args)
         : aligned_buffer(internal_constructor{ }, _size, std::move(_alloc), std::forward<Ts>(_args)...)
     {
+    }
+
+        //
+        // Constructs a buffer of `_size` elements, where every element is constructed by the thread of the thread squad that
+        // processes its index when the index range is partitioned according to `_sched`.
+        //ᅟ
+        // With a first-touch page placement policy, as employed by Linux, memory pages are thus placed on the NUMA node of the
+        // thread that constructs the elements. Subsequent accesses should use the same thread squad and partitioning.
+        // The element type must be nothrow-constructible.
+        //
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_buffer(thread_squad& _threadSquad, std::size_t _size, thread_squad::schedule _sched = { })
+        : aligned_buffer(internal_constructor{ }, _threadSquad, _sched, _size, { })
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_buffer(thread_squad& _threadSquad, std::size_t _size, T const& _value, thread_squad::schedule _sched = { })
+        : aligned_buffer(internal_constructor{ }, _threadSquad, _sched, _size, { }, _value)
+    {
+    }
+    explicit aligned_buffer(thread_squad& _threadSquad, std::size_t _size, A _alloc, thread_squad::schedule _sched = { })
+        : aligned_buffer(internal_constructor{ }, _threadSquad, _sched, _size, std::move(_alloc))
+    {
+    }
+    explicit aligned_buffer(thread_squad& _threadSquad, std::size_t _size, T const& _value, A _alloc, thread_squad::schedule _sched = { })
+        : aligned_buffer(internal_constructor{ }, _threadSquad, _sched, _size, std::move(_alloc), _value)
+    {
     }
 
     constexpr aligned_buffer(aligned_buffer&& rhs) noexcept
@@ -262,21 +338,24 @@ public:
 
 
     //
-    // Two-dimensional buffer with aligned rows.
+    // Growable buffer with aligned elements.
     //ᅟ
-    //ᅟ    auto threadData = aligned_row_buffer<float, cache_line_alignment>(rows, cols);
-    //ᅟ    // every `threadData[i][0]` has cache-line alignment => no false sharing
+    //ᅟ    auto samples = aligned_vector<double, cache_line_alignment, page_allocator<double>>{ };
+    //ᅟ    samples.resize_for_overwrite(n);  // elements are default-initialized
+    //ᅟ
+    // The elements have the same alignment guarantees as in `aligned_buffer<>`. Unlike `std::vector<>`,
+    // `resize_for_overwrite()` grows the vector without value-initializing the new elements. If the element type is
+    // trivially copyable and the allocator can resize allocations in place, as `page_allocator<>` can, the storage is grown
+    // without copying the elements.
     //ᅟ
     // Supports special alignment values such as `cache_line_alignment`.
     // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
     //
 template <typename T, std::size_t Alignment, typename A = aligned_allocator<T, Alignment>>
-class aligned_row_buffer : private aligned_allocator_adaptor<T, Alignment | alignof(T), A>
+class aligned_vector : private aligned_allocator_adaptor<T, Alignment | alignof(T), A>
 {
-    static_assert(!std::is_const<T>::value && !std::is_volatile<T>::value, "buffer element type must not have cv qualifiers");
-    static_assert(!std::is_reference<T>::value, "buffer element type must not be a reference");
-
-    struct internal_constructor { };
+    static_assert(!std::is_const<T>::value && !std::is_volatile<T>::value, "vector element type must not have cv qualifiers");
+    static_assert(!std::is_reference<T>::value, "vector element type must not be a reference");
 
 public:
     using allocator_type = aligned_allocator_adaptor<T, Alignment | alignof(T), A>;
@@ -284,108 +363,162 @@ public:
 private:
     using byte_allocator_ = typename std::allocator_traits<allocator_type>::template rebind_alloc<char>;
 
+        // Trivially copyable elements can be relocated by the allocator without calling constructors and destructors.
+    static constexpr bool canReallocate_ = std::is_trivially_copyable_v<T> && detail::has_member_reallocate<byte_allocator_>::value;
+
     gsl::owner<char*> data_;
-    std::size_t rows_;
-    std::size_t cols_;
-    std::size_t bytesPerRow_;
+    std::size_t size_; // # elements
+    std::size_t capacity_; // # elements
+    std::size_t bytesPerElement_;
 
-    template <typename... Ts>
-    aligned_row_buffer(internal_constructor, std::size_t _rows, std::size_t _cols, allocator_type _allocator, Ts&&... args)
-        : allocator_type(std::move(_allocator)), rows_(_rows), cols_(_cols)
+    std::size_t
+    static computeBytesPerElement()
     {
-        auto rawBytesPerRowR = detail::try_multiply_unsigned(sizeof(T), _cols);
-        auto bytesPerRowR = detail::try_ceili(rawBytesPerRowR.value, detail::alignment_in_bytes(Alignment | alignof(T)));
-        auto numBytesR = detail::try_multiply_unsigned(_rows, bytesPerRowR.value);
-        if (rawBytesPerRowR.ec != std::errc{ } || bytesPerRowR.ec != std::errc{ } || numBytesR.ec != std::errc{ }) throw std::bad_alloc{ };
-        bytesPerRow_ = bytesPerRowR.value;
+        auto bytesPerElementR = detail::try_ceili(sizeof(T), detail::alignment_in_bytes(Alignment | alignof(T)));
+        if (bytesPerElementR.ec != std::errc{ }) throw std::bad_alloc{ };
+        return bytesPerElementR.value;
+    }
 
-        if (_rows == 0 || _cols == 0)
+    T*
+    element(char* data, std::size_t i) const noexcept
+    {
+        return reinterpret_cast<T*>(&data[i * bytesPerElement_]);
+    }
+
+    void
+    reallocate(std::size_t newCapacity)
+    {
+        gsl_Expects(newCapacity >= size_);
+
+        auto numBytesR = detail::try_multiply_unsigned(newCapacity, bytesPerElement_);
+        if (numBytesR.ec != std::errc{ }) throw std::bad_alloc{ };
+        std::size_t numBytes = numBytesR.value;
+
+        auto alloc = byte_allocator_(get_allocator());
+        if constexpr (canReallocate_)
         {
-            data_ = nullptr;
+            if (data_ != nullptr)
+            {
+                data_ = alloc.reallocate(data_, capacity_ * bytesPerElement_, numBytes);
+                capacity_ = newCapacity;
+                return;
+            }
         }
-        else
+        char* newData = std::allocator_traits<byte_allocator_>::allocate(alloc, numBytes);
+
+        std::size_t numElementsMoved = 0;
+        auto transaction = detail::make_transaction(
+            std::negation<std::is_nothrow_move_constructible<T>>{ },
+            [this, newData, numBytes, &numElementsMoved]
+            {
+                detail::destroy_aligned_buffer<T>(newData, get_allocator(), numElementsMoved, bytesPerElement_);
+                auto alloc = byte_allocator_(get_allocator());
+                std::allocator_traits<byte_allocator_>::deallocate(alloc, newData, numBytes);
+            });
+        auto lalloc = get_allocator();
+        for (; numElementsMoved != size_; ++numElementsMoved)
         {
-            auto alloc = byte_allocator_(get_allocator());
-            data_ = std::allocator_traits<byte_allocator_>::allocate(alloc, numBytesR.value);
+            std::allocator_traits<allocator_type>::construct(lalloc, element(newData, numElementsMoved),
+                std::move_if_noexcept(*element(data_, numElementsMoved)));
+        }
+        transaction.commit();
 
-            std::size_t numElementsConstructed;
-            auto transaction = detail::make_transaction(
-                std::negation<std::is_nothrow_constructible<T, Ts...>>{ },
-                [this, &numElementsConstructed]
-                {
-                    detail::destroy_aligned_row_buffer<T>(data_, get_allocator(), rows_, cols_, bytesPerRow_, numElementsConstructed);
-                    auto alloc = byte_allocator_(get_allocator());
-                    std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, rows_ * bytesPerRow_);
-                });
-            detail::construct_aligned_row_buffer<T>(data_, get_allocator(), numElementsConstructed, _rows, _cols, bytesPerRow_,
-                std::is_nothrow_constructible<T, Ts...>{ }, std::forward<Ts>(args)...);
-            transaction.commit();
+        if (data_ != nullptr)
+        {
+            destroy_and_free();
         }
+        data_ = newData;
+        capacity_ = newCapacity;
     }
-    void destroy_and_free() noexcept
+    void
+    grow(std::size_t minCapacity)
     {
-        detail::destroy_aligned_row_buffer<T>(data_, get_allocator(), rows_, cols_, bytesPerRow_);
+        std::size_t newCapacity = capacity_ <= std::numeric_limits<std::size_t>::max() / 2 ? 2*capacity_ : capacity_;
+        reallocate(std::max(newCapacity, minCapacity));
+    }
+    template <typename InitFuncT>
+    void
+    resize_with(std::size_t newSize, InitFuncT&& initFunc)
+    {
+        if (newSize <= size_)
+        {
+            detail::destroy_aligned_buffer<T>(&data_[newSize * bytesPerElement_], get_allocator(), size_ - newSize, bytesPerElement_);
+            size_ = newSize;
+        }
+        else
+        {
+            if (newSize > capacity_)
+            {
+                grow(newSize);
+            }
+            for (; size_ != newSize; ++size_)
+            {
+                initFunc(element(data_, size_));
+            }
+        }
+    }
+    void
+    destroy_and_free() noexcept
+    {
+        detail::destroy_aligned_buffer<T>(data_, get_allocator(), size_, bytesPerElement_);
         auto alloc = byte_allocator_(get_allocator());
-        std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, rows_ * bytesPerRow_);
+        std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, capacity_ * bytesPerElement_);
     }
 
 public:
+    using value_type = T;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
-    using reference = std::span<T>;
-    using const_reference = std::span<T const>;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using reference = T&;
+    using const_reference = T const&;
 
-    using iterator = detail::aligned_row_buffer_iterator<T>;
-    using const_iterator = detail::aligned_row_buffer_iterator<T const>;
+    using iterator = detail::aligned_buffer_iterator<T>;
+    using const_iterator = detail::aligned_buffer_iterator<T const>;
 
     template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
-    aligned_row_buffer() noexcept
-        : allocator_type{ }, data_(nullptr), rows_(0), cols_(0), bytesPerRow_(0)
+    aligned_vector() noexcept
+        : allocator_type{ }, data_(nullptr), size_(0), capacity_(0), bytesPerElement_(computeBytesPerElement())
     {
     }
-    aligned_row_buffer(allocator_type _alloc) noexcept
-        : allocator_type(std::move(_alloc)), data_(nullptr), rows_(0), cols_(0), bytesPerRow_(0)
+    aligned_vector(allocator_type _alloc) noexcept
+        : allocator_type(std::move(_alloc)), data_(nullptr), size_(0), capacity_(0), bytesPerElement_(computeBytesPerElement())
     {
     }
     template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
-    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols)
-        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, { })
+    explicit aligned_vector(std::size_t _size)
+        : aligned_vector(allocator_type{ })
     {
+        resize(_size);
     }
     template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
-    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, T const& _value)
-        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, { }, _value)
-    {
-    }
-    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, A _alloc)
-        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, std::move(_alloc))
-    {
-    }
-    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, T const& _value, A _alloc)
-        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, std::move(_alloc), _value)
+    explicit aligned_vector(std::size_t _size, T const& _value)
+        : aligned_vector(allocator_type{ })
     {
+        resize(_size, _value);
     }
-    template <typename... Ts,
-              typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
-    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, std::in_place_t, Ts&&... _args)
-        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, { }, std::forward<Ts>(_args)...)
+    explicit aligned_vector(std::size_t _size, A _alloc)
+        : aligned_vector(allocator_type(std::move(_alloc)))
     {
+        resize(_size);
     }
-    template <typename... Ts>
-    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, A _alloc, std::in_place_t, Ts&&... _args)
-        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, std::move(_alloc), std::forward<Ts>(_args)...)
+    explicit aligned_vector(std::size_t _size, T const& _value, A _alloc)
+        : aligned_vector(allocator_type(std::move(_alloc)))
     {
+        resize(_size, _value);
     }
 
-    constexpr aligned_row_buffer(aligned_row_buffer&& rhs) noexcept
-        : data_(std::exchange(rhs.data_, { })),
-          rows_(std::exchange(rhs.rows_, { })),
-          cols_(std::exchange(rhs.cols_, { })),
-          bytesPerRow_(std::exchange(rhs.bytesPerRow_, { }))
+    aligned_vector(aligned_vector&& rhs) noexcept
+        : allocator_type(rhs.get_allocator()),
+          data_(std::exchange(rhs.data_, { })),
+          size_(std::exchange(rhs.size_, { })),
+          capacity_(std::exchange(rhs.capacity_, { })),
+          bytesPerElement_(rhs.bytesPerElement_)
     {
     }
-    constexpr aligned_row_buffer&
-    operator =(aligned_row_buffer&& rhs) noexcept
+    aligned_vector&
+    operator =(aligned_vector&& rhs) noexcept
     {
         if (this != &rhs)
         {
@@ -393,14 +526,15 @@ public:
             {
                 destroy_and_free();
             }
+            static_cast<allocator_type&>(*this) = rhs.get_allocator();
             data_ = std::exchange(rhs.data_, { });
-            rows_ = std::exchange(rhs.rows_, { });
-            cols_ = std::exchange(rhs.cols_, { });
-            bytesPerRow_ = std::exchange(rhs.bytesPerRow_, { });
+            size_ = std::exchange(rhs.size_, { });
+            capacity_ = std::exchange(rhs.capacity_, { });
         }
+        return *this;
     }
 
-    ~aligned_row_buffer()
+    ~aligned_vector()
     {
         if (data_ != nullptr)
         {
@@ -415,61 +549,55 @@ public:
     }
 
     [[nodiscard]] std::size_t
-    rows() const noexcept
-    {
-        return rows_;
-    }
-    [[nodiscard]] std::size_t
-    columns() const noexcept
+    size() const noexcept
     {
-        return cols_;
+        return size_;
     }
-
     [[nodiscard]] std::size_t
-    size() const noexcept
+    capacity() const noexcept
     {
-        return rows();
+        return capacity_;
     }
-    [[nodiscard]] std::span<T>
+    [[nodiscard]] reference
     operator [](std::size_t i)
     {
-        gsl_Expects(i < rows_);
+        gsl_Expects(i < size_);
 
-        return { reinterpret_cast<T*>(&data_[i * bytesPerRow_]), cols_ };
+        return *element(data_, i);
     }
-    [[nodiscard]] std::span<T const>
+    [[nodiscard]] const_reference
     operator [](std::size_t i) const
     {
-        gsl_Expects(i < rows_);
+        gsl_Expects(i < size_);
 
-        return { reinterpret_cast<T*>(&data_[i * bytesPerRow_]), cols_ };
+        return *element(data_, i);
     }
 
     [[nodiscard]] iterator
     begin() noexcept
     {
-        return { data_, 0, cols_, bytesPerRow_ };
+        return { data_, 0, bytesPerElement_ };
     }
     [[nodiscard]] const_iterator
     begin() const noexcept
     {
-        return { data_, 0, cols_, bytesPerRow_ };
+        return { data_, 0, bytesPerElement_ };
     }
     [[nodiscard]] iterator
     end() noexcept
     {
-        return { data_, rows_, cols_, bytesPerRow_ };
+        return { data_, size_, bytesPerElement_ };
     }
     [[nodiscard]] const_iterator
     end() const noexcept
     {
-        return { data_, rows_, cols_, bytesPerRow_ };
+        return { data_, size_, bytesPerElement_ };
     }
 
     [[nodiscard]] constexpr bool
     empty() const noexcept
     {
-        return rows_ == 0;
+        return size_ == 0;
     }
 
     [[nodiscard]] reference
@@ -496,6 +624,1139 @@ public:
         gsl_Expects(!empty());
         return (*this)[size() - 1];
     }
+
+        //
+        // Ensures that the vector can hold at least `_capacity` elements without reallocation.
+        //
+    void
+    reserve(std::size_t _capacity)
+    {
+        if (_capacity > capacity_)
+        {
+            reallocate(_capacity);
+        }
+    }
+
+        //
+        // Destroys all elements. The capacity remains unchanged.
+        //
+    void
+    clear() noexcept
+    {
+        detail::destroy_aligned_buffer<T>(data_, get_allocator(), size_, bytesPerElement_);
+        size_ = 0;
+    }
+
+        //
+        // Resizes the vector to `_size` elements. New elements are value-initialized, or copy-constructed from `_value`.
+        //
+    void
+    resize(std::size_t _size)
+    {
+        auto lalloc = get_allocator();
+        resize_with(_size,
+            [&lalloc](T* p)
+            {
+                std::allocator_traits<allocator_type>::construct(lalloc, p);
+            });
+    }
+    void
+    resize(std::size_t _size, T const& _value)
+    {
+        auto lalloc = get_allocator();
+        auto construct = [&lalloc](T* p, T const& value)
+        {
+            std::allocator_traits<allocator_type>::construct(lalloc, p, value);
+        };
+        if (_size > capacity_)
+        {
+                // `_value` might refer to an element of the vector, which would be invalidated by reallocation.
+            auto value = T(_value);
+            resize_with(_size, [&construct, &value](T* p) { construct(p, value); });
+        }
+        else
+        {
+            resize_with(_size, [&construct, &_value](T* p) { construct(p, _value); });
+        }
+    }
+
+        //
+        // Resizes the vector to `_size` elements. New elements are default-initialized, which means that elements of
+        // trivially default-constructible type are left uninitialized and are meant to be overwritten.
+        //
+    void
+    resize_for_overwrite(std::size_t _size)
+    {
+        resize_with(_size,
+            [](T* p)
+            {
+                ::new (static_cast<void*>(p)) T;
+            });
+    }
+
+    void
+    push_back(T const& value)
+    {
+        emplace_back(value);
+    }
+    void
+    push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+    template <typename... Ts>
+    reference
+    emplace_back(Ts&&... args)
+    {
+        auto lalloc = get_allocator();
+        if (size_ == capacity_)
+        {
+                // The arguments might refer to an element of the vector, which would be invalidated by reallocation.
+            auto value = T(std::forward<Ts>(args)...);
+            grow(size_ + 1);
+            std::allocator_traits<allocator_type>::construct(lalloc, element(data_, size_), std::move(value));
+        }
+        else
+        {
+            std::allocator_traits<allocator_type>::construct(lalloc, element(data_, size_), std::forward<Ts>(args)...);
+        }
+        return *element(data_, size_++);
+    }
+    void
+    pop_back()
+    {
+        gsl_Expects(!empty());
+
+        auto lalloc = get_allocator();
+        --size_;
+        std::allocator_traits<allocator_type>::destroy(lalloc, element(data_, size_));
+    }
+};
+
+
+    //
+    // Two-dimensional buffer with aligned rows.
+    //ᅟ
+    //ᅟ    auto threadData = aligned_row_buffer<float, cache_line_alignment>(rows, cols);
+    //ᅟ    // every `threadData[i][0]` has cache-line alignment => no false sharing
+    //ᅟ
+    // By default, rows are padded only as required by the alignment. With `row_padding::avoid_cache_aliasing`, rows are padded
+    // further if the distance between adjacent rows would be a multiple of a large power of 2, as determined from the cache
+    // geometry, such that column-wise traversals do not map to only a few cache sets.
+    //ᅟ
+    // Supports special alignment values such as `cache_line_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+template <typename T, std::size_t Alignment, typename A = aligned_allocator<T, Alignment>, row_padding Padding = row_padding::none>
+class aligned_row_buffer : private aligned_allocator_adaptor<T, Alignment | alignof(T), A>
+{
+    static_assert(!std::is_const<T>::value && !std::is_volatile<T>::value, "buffer element type must not have cv qualifiers");
+    static_assert(!std::is_reference<T>::value, "buffer element type must not be a reference");
+
+    struct internal_constructor { };
+
+public:
+    using allocator_type = aligned_allocator_adaptor<T, Alignment | alignof(T), A>;
+
+private:
+    using byte_allocator_ = typename std::allocator_traits<allocator_type>::template rebind_alloc<char>;
+
+    gsl::owner<char*> data_;
+    std::size_t rows_;
+    std::size_t cols_;
+    std::size_t bytesPerRow_;
+
+    template <typename... Ts>
+    aligned_row_buffer(internal_constructor, std::size_t _rows, std::size_t _cols, allocator_type _allocator, Ts&&... args)
+        : allocator_type(std::move(_allocator)), rows_(_rows), cols_(_cols)
+    {
+        auto rawBytesPerRowR = detail::try_multiply_unsigned(sizeof(T), _cols);
+        if (rawBytesPerRowR.ec != std::errc{ }) throw std::bad_alloc{ };
+        bytesPerRow_ = detail::padded_row_size(rawBytesPerRowR.value, detail::alignment_in_bytes(Alignment | alignof(T)), Padding);
+        auto numBytesR = detail::try_multiply_unsigned(_rows, bytesPerRow_);
+        if (numBytesR.ec != std::errc{ }) throw std::bad_alloc{ };
+
+        if (_rows == 0 || _cols == 0)
+        {
+            data_ = nullptr;
+        }
+        else
+        {
+            auto alloc = byte_allocator_(get_allocator());
+            data_ = std::allocator_traits<byte_allocator_>::allocate(alloc, numBytesR.value);
+
+            std::size_t numElementsConstructed;
+            auto transaction = detail::make_transaction(
+                std::negation<std::is_nothrow_constructible<T, Ts...>>{ },
+                [this, &numElementsConstructed]
+                {
+                    detail::destroy_aligned_row_buffer<T>(data_, get_allocator(), rows_, cols_, bytesPerRow_, numElementsConstructed);
+                    auto alloc = byte_allocator_(get_allocator());
+                    std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, rows_ * bytesPerRow_);
+                });
+            detail::construct_aligned_row_buffer<T>(data_, get_allocator(), numElementsConstructed, _rows, _cols, bytesPerRow_,
+                std::is_nothrow_constructible<T, Ts...>{ }, std::forward<Ts>(args)...);
+            transaction.commit();
+        }
+    }
+    void destroy_and_free() noexcept
+    {
+        detail::destroy_aligned_row_buffer<T>(data_, get_allocator(), rows_, cols_, bytesPerRow_);
+        auto alloc = byte_allocator_(get_allocator());
+        std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, rows_ * bytesPerRow_);
+    }
+
+public:
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::span<T>;
+    using const_reference = std::span<T const>;
+
+    using iterator = detail::aligned_row_buffer_iterator<T>;
+    using const_iterator = detail::aligned_row_buffer_iterator<T const>;
+
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    aligned_row_buffer() noexcept
+        : allocator_type{ }, data_(nullptr), rows_(0), cols_(0), bytesPerRow_(0)
+    {
+    }
+    aligned_row_buffer(allocator_type _alloc) noexcept
+        : allocator_type(std::move(_alloc)), data_(nullptr), rows_(0), cols_(0), bytesPerRow_(0)
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols)
+        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, { })
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, T const& _value)
+        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, { }, _value)
+    {
+    }
+    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, A _alloc)
+        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, std::move(_alloc))
+    {
+    }
+    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, T const& _value, A _alloc)
+        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, std::move(_alloc), _value)
+    {
+    }
+    template <typename... Ts,
+              typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, std::in_place_t, Ts&&... _args)
+        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, { }, std::forward<Ts>(_args)...)
+    {
+    }
+    template <typename... Ts>
+    explicit aligned_row_buffer(std::size_t _rows, std::size_t _cols, A _alloc, std::in_place_t, Ts&&... _args)
+        : aligned_row_buffer(internal_constructor{ }, _rows, _cols, std::move(_alloc), std::forward<Ts>(_args)...)
+    {
+    }
+
+    constexpr aligned_row_buffer(aligned_row_buffer&& rhs) noexcept
+        : data_(std::exchange(rhs.data_, { })),
+          rows_(std::exchange(rhs.rows_, { })),
+          cols_(std::exchange(rhs.cols_, { })),
+          bytesPerRow_(std::exchange(rhs.bytesPerRow_, { }))
+    {
+    }
+    constexpr aligned_row_buffer&
+    operator =(aligned_row_buffer&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            if (data_ != nullptr)
+            {
+                destroy_and_free();
+            }
+            data_ = std::exchange(rhs.data_, { });
+            rows_ = std::exchange(rhs.rows_, { });
+            cols_ = std::exchange(rhs.cols_, { });
+            bytesPerRow_ = std::exchange(rhs.bytesPerRow_, { });
+        }
+    }
+
+    ~aligned_row_buffer()
+    {
+        if (data_ != nullptr)
+        {
+            destroy_and_free();
+        }
+    }
+
+    [[nodiscard]] allocator_type
+    get_allocator() const noexcept
+    {
+        return *this;
+    }
+
+    [[nodiscard]] std::size_t
+    rows() const noexcept
+    {
+        return rows_;
+    }
+    [[nodiscard]] std::size_t
+    columns() const noexcept
+    {
+        return cols_;
+    }
+
+    [[nodiscard]] std::size_t
+    size() const noexcept
+    {
+        return rows();
+    }
+    [[nodiscard]] std::span<T>
+    operator [](std::size_t i)
+    {
+        gsl_Expects(i < rows_);
+
+        return { reinterpret_cast<T*>(&data_[i * bytesPerRow_]), cols_ };
+    }
+    [[nodiscard]] std::span<T const>
+    operator [](std::size_t i) const
+    {
+        gsl_Expects(i < rows_);
+
+        return { reinterpret_cast<T*>(&data_[i * bytesPerRow_]), cols_ };
+    }
+
+    [[nodiscard]] iterator
+    begin() noexcept
+    {
+        return { data_, 0, cols_, bytesPerRow_ };
+    }
+    [[nodiscard]] const_iterator
+    begin() const noexcept
+    {
+        return { data_, 0, cols_, bytesPerRow_ };
+    }
+    [[nodiscard]] iterator
+    end() noexcept
+    {
+        return { data_, rows_, cols_, bytesPerRow_ };
+    }
+    [[nodiscard]] const_iterator
+    end() const noexcept
+    {
+        return { data_, rows_, cols_, bytesPerRow_ };
+    }
+
+    [[nodiscard]] constexpr bool
+    empty() const noexcept
+    {
+        return rows_ == 0;
+    }
+
+    [[nodiscard]] reference
+    front()
+    {
+        gsl_Expects(!empty());
+        return (*this)[0];
+    }
+    [[nodiscard]] const_reference
+    front() const
+    {
+        gsl_Expects(!empty());
+        return (*this)[0];
+    }
+    [[nodiscard]] reference
+    back()
+    {
+        gsl_Expects(!empty());
+        return (*this)[size() - 1];
+    }
+    [[nodiscard]] const_reference
+    back() const
+    {
+        gsl_Expects(!empty());
+        return (*this)[size() - 1];
+    }
+};
+
+
+    //
+    // Structure-of-arrays buffer where the elements of every field are stored in a separate array with aligned beginning.
+    //ᅟ
+    //ᅟ    auto particles = aligned_soa_buffer<std::tuple<float, float, float, double>, cache_line_alignment>(n);
+    //ᅟ    auto [x, y, z, mass] = particles[i];  // references to the fields of the i-th element
+    //ᅟ    std::span<float> xs = particles.field<0>();  // every field array has cache-line alignment => suitable for SIMD loops
+    //ᅟ
+    // All field arrays share a single allocation. Every field array is padded to a multiple of the alignment.
+    //ᅟ
+    // Supports special alignment values such as `cache_line_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+template <typename T, std::size_t Alignment, typename A = aligned_allocator<T, Alignment>>
+class aligned_soa_buffer;
+template <typename... Ts, std::size_t Alignment, typename A>
+class aligned_soa_buffer<std::tuple<Ts...>, Alignment, A> : private aligned_allocator_adaptor<std::tuple<Ts...>, (Alignment | ... | alignof(Ts)), A>
+{
+    static_assert(sizeof...(Ts) > 0, "buffer must have at least one field");
+    static_assert(((!std::is_const<Ts>::value && !std::is_volatile<Ts>::value) && ...), "buffer field types must not have cv qualifiers");
+    static_assert((!std::is_reference<Ts>::value && ...), "buffer field types must not be references");
+
+    struct internal_constructor { };
+
+public:
+    using allocator_type = aligned_allocator_adaptor<std::tuple<Ts...>, (Alignment | ... | alignof(Ts)), A>;
+
+    template <std::size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+private:
+    using byte_allocator_ = typename std::allocator_traits<allocator_type>::template rebind_alloc<char>;
+    using offsets_ = std::array<std::size_t, sizeof...(Ts) + 1>;
+
+    gsl::owner<char*> data_;
+    std::size_t size_; // # elements
+    offsets_ fieldOffsets_; // offsets of the field arrays in bytes; the last entry is the size of the allocation
+
+    static offsets_
+    computeFieldOffsets(std::size_t _size)
+    {
+        constexpr std::size_t fieldSizes[] = { sizeof(Ts)... };
+        std::size_t a = detail::alignment_in_bytes((Alignment | ... | alignof(Ts)));
+        auto result = offsets_{ };
+        for (std::size_t i = 0; i != sizeof...(Ts); ++i)
+        {
+            auto rawBytesPerFieldR = detail::try_multiply_unsigned(fieldSizes[i], _size);
+            auto bytesPerFieldR = detail::try_ceili(rawBytesPerFieldR.value, a);
+            if (rawBytesPerFieldR.ec != std::errc{ } || bytesPerFieldR.ec != std::errc{ }
+                || bytesPerFieldR.value > std::numeric_limits<std::size_t>::max() - result[i]) throw std::bad_alloc{ };
+            result[i + 1] = result[i] + bytesPerFieldR.value;
+        }
+        return result;
+    }
+
+    template <std::size_t I>
+    field_type<I>*
+    field_data() const noexcept
+    {
+        return reinterpret_cast<field_type<I>*>(data_ + fieldOffsets_[I]);
+    }
+    template <std::size_t... Is>
+    std::tuple<Ts*...>
+    field_pointers(std::index_sequence<Is...>) const noexcept
+    {
+        return { field_data<Is>()... };
+    }
+    template <std::size_t... Is>
+    std::tuple<Ts&...>
+    element(std::size_t i, std::index_sequence<Is...>) const noexcept
+    {
+        return { field_data<Is>()[i]... };
+    }
+
+    template <std::size_t I, bool IsNothrowConstructible, typename... Vs>
+    void
+    construct_fields(Vs const&... value)
+    {
+        if constexpr (I != sizeof...(Ts))
+        {
+            using F = field_type<I>;
+            char* fieldData = reinterpret_cast<char*>(field_data<I>());
+            std::size_t numElementsConstructed = 0;
+            {
+                auto transaction = detail::make_transaction(
+                    std::bool_constant<!IsNothrowConstructible>{ },
+                    [this, fieldData, &numElementsConstructed]
+                    {
+                        detail::destroy_aligned_buffer<F>(fieldData, get_allocator(), numElementsConstructed, sizeof(F));
+                    });
+                detail::construct_aligned_buffer<F>(fieldData, get_allocator(), numElementsConstructed, size_, sizeof(F),
+                    std::is_nothrow_constructible<F, decltype(std::get<I>(value))...>{ }, std::get<I>(value)...);
+                transaction.commit();
+            }
+            auto transaction = detail::make_transaction(
+                std::bool_constant<!IsNothrowConstructible>{ },
+                [this, fieldData]
+                {
+                    detail::destroy_aligned_buffer<F>(fieldData, get_allocator(), size_, sizeof(F));
+                });
+            construct_fields<I + 1, IsNothrowConstructible>(value...);
+            transaction.commit();
+        }
+    }
+
+        // `Vs` is either empty, in which case the elements are value-initialized, or a single `std::tuple<Ts...>` which
+        // holds the initial values of the fields.
+    template <typename... Vs>
+    aligned_soa_buffer(internal_constructor, std::size_t _size, allocator_type _allocator, Vs const&... value)
+        : allocator_type(std::move(_allocator)), size_(_size), fieldOffsets_(computeFieldOffsets(_size))
+    {
+        if (_size == 0)
+        {
+            data_ = nullptr;
+        }
+        else
+        {
+            auto alloc = byte_allocator_(get_allocator());
+            data_ = std::allocator_traits<byte_allocator_>::allocate(alloc, fieldOffsets_.back());
+
+            constexpr bool isNothrowConstructible = sizeof...(Vs) == 0
+                ? (std::is_nothrow_default_constructible_v<Ts> && ...)
+                : (std::is_nothrow_copy_constructible_v<Ts> && ...);
+            auto transaction = detail::make_transaction(
+                std::bool_constant<!isNothrowConstructible>{ },
+                [this]
+                {
+                    auto alloc = byte_allocator_(get_allocator());
+                    std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, fieldOffsets_.back());
+                });
+            construct_fields<0, isNothrowConstructible>(value...);
+            transaction.commit();
+        }
+    }
+    template <std::size_t... Is>
+    void
+    destroy_and_free(std::index_sequence<Is...>) noexcept
+    {
+        (detail::destroy_aligned_buffer<field_type<Is>>(reinterpret_cast<char*>(field_data<Is>()), get_allocator(), size_, sizeof(field_type<Is>)), ...);
+        auto alloc = byte_allocator_(get_allocator());
+        std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, fieldOffsets_.back());
+    }
+
+public:
+    using value_type = std::tuple<Ts...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<Ts const&...>;
+
+    using iterator = detail::aligned_soa_buffer_iterator<Ts...>;
+    using const_iterator = detail::aligned_soa_buffer_iterator<Ts const...>;
+
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    constexpr aligned_soa_buffer() noexcept
+        : allocator_type{ }, data_(nullptr), size_(0), fieldOffsets_{ }
+    {
+    }
+    aligned_soa_buffer(allocator_type _alloc) noexcept
+        : allocator_type(std::move(_alloc)), data_(nullptr), size_(0), fieldOffsets_{ }
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_soa_buffer(std::size_t _size)
+        : aligned_soa_buffer(internal_constructor{ }, _size, { })
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_soa_buffer(std::size_t _size, value_type const& _value)
+        : aligned_soa_buffer(internal_constructor{ }, _size, { }, _value)
+    {
+    }
+    explicit aligned_soa_buffer(std::size_t _size, A _alloc)
+        : aligned_soa_buffer(internal_constructor{ }, _size, std::move(_alloc))
+    {
+    }
+    explicit aligned_soa_buffer(std::size_t _size, value_type const& _value, A _alloc)
+        : aligned_soa_buffer(internal_constructor{ }, _size, std::move(_alloc), _value)
+    {
+    }
+
+    constexpr aligned_soa_buffer(aligned_soa_buffer&& rhs) noexcept
+        : allocator_type(rhs.get_allocator()),
+          data_(std::exchange(rhs.data_, { })),
+          size_(std::exchange(rhs.size_, { })),
+          fieldOffsets_(std::exchange(rhs.fieldOffsets_, { }))
+    {
+    }
+    constexpr aligned_soa_buffer&
+    operator =(aligned_soa_buffer&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            if (data_ != nullptr)
+            {
+                destroy_and_free(std::index_sequence_for<Ts...>{ });
+            }
+            static_cast<allocator_type&>(*this) = rhs.get_allocator();
+            data_ = std::exchange(rhs.data_, { });
+            size_ = std::exchange(rhs.size_, { });
+            fieldOffsets_ = std::exchange(rhs.fieldOffsets_, { });
+        }
+        return *this;
+    }
+
+    ~aligned_soa_buffer()
+    {
+        if (data_ != nullptr)
+        {
+            destroy_and_free(std::index_sequence_for<Ts...>{ });
+        }
+    }
+
+    [[nodiscard]] allocator_type
+    get_allocator() const noexcept
+    {
+        return *this;
+    }
+
+    [[nodiscard]] std::size_t
+    size() const noexcept
+    {
+        return size_;
+    }
+
+        //
+        // Returns the contiguous array of the `I`-th field of all elements.
+        //
+    template <std::size_t I>
+    [[nodiscard]] std::span<field_type<I>>
+    field() noexcept
+    {
+        return { field_data<I>(), size_ };
+    }
+    template <std::size_t I>
+    [[nodiscard]] std::span<field_type<I> const>
+    field() const noexcept
+    {
+        return { field_data<I>(), size_ };
+    }
+
+        //
+        // Returns a tuple of references to the fields of the `i`-th element.
+        //
+    [[nodiscard]] reference
+    operator [](std::size_t i)
+    {
+        gsl_Expects(i < size_);
+
+        return element(i, std::index_sequence_for<Ts...>{ });
+    }
+    [[nodiscard]] const_reference
+    operator [](std::size_t i) const
+    {
+        gsl_Expects(i < size_);
+
+        return element(i, std::index_sequence_for<Ts...>{ });
+    }
+
+    [[nodiscard]] iterator
+    begin() noexcept
+    {
+        return { field_pointers(std::index_sequence_for<Ts...>{ }), 0 };
+    }
+    [[nodiscard]] const_iterator
+    begin() const noexcept
+    {
+        return { field_pointers(std::index_sequence_for<Ts...>{ }), 0 };
+    }
+    [[nodiscard]] iterator
+    end() noexcept
+    {
+        return { field_pointers(std::index_sequence_for<Ts...>{ }), size_ };
+    }
+    [[nodiscard]] const_iterator
+    end() const noexcept
+    {
+        return { field_pointers(std::index_sequence_for<Ts...>{ }), size_ };
+    }
+
+    [[nodiscard]] constexpr bool
+    empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] reference
+    front()
+    {
+        gsl_Expects(!empty());
+        return (*this)[0];
+    }
+    [[nodiscard]] const_reference
+    front() const
+    {
+        gsl_Expects(!empty());
+        return (*this)[0];
+    }
+    [[nodiscard]] reference
+    back()
+    {
+        gsl_Expects(!empty());
+        return (*this)[size() - 1];
+    }
+    [[nodiscard]] const_reference
+    back() const
+    {
+        gsl_Expects(!empty());
+        return (*this)[size() - 1];
+    }
+};
+
+
+    //
+    // Multi-dimensional buffer in row-major order where the rows of the innermost dimension are aligned.
+    //ᅟ
+    //ᅟ    auto grid = aligned_tensor_buffer<double, 3, cache_line_alignment>({ nx, ny, nz });
+    //ᅟ    grid(i, j, k) = 0.;  // every `&grid(i, j, 0)` has cache-line alignment
+    //ᅟ
+    // The stride of the second-innermost dimension is the extent of the innermost dimension, rounded up such that every row
+    // begins at an aligned address, and padded further according to the padding policy. By default, the stride is padded
+    // if it would be a multiple of 4 KiB to avoid 4K aliasing between adjacent rows; with `row_padding::avoid_cache_aliasing`,
+    // it is padded as for `aligned_row_buffer<>` if it would be a multiple of a large power of 2. The strides of the outer
+    // dimensions are not padded.
+    //ᅟ
+    // Supports special alignment values such as `cache_line_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+template <typename T, std::size_t Rank, std::size_t Alignment, typename A = aligned_allocator<T, Alignment>,
+          row_padding Padding = row_padding::avoid_4k_aliasing>
+class aligned_tensor_buffer : private aligned_allocator_adaptor<T, Alignment | alignof(T), A>
+{
+    static_assert(!std::is_const<T>::value && !std::is_volatile<T>::value, "buffer element type must not have cv qualifiers");
+    static_assert(!std::is_reference<T>::value, "buffer element type must not be a reference");
+    static_assert(Rank > 0, "buffer must have at least one dimension");
+
+    struct internal_constructor { };
+
+public:
+    using allocator_type = aligned_allocator_adaptor<T, Alignment | alignof(T), A>;
+
+private:
+    using byte_allocator_ = typename std::allocator_traits<allocator_type>::template rebind_alloc<char>;
+    using indices_ = std::array<std::size_t, Rank>;
+
+    gsl::owner<char*> data_;
+    indices_ extents_;
+    indices_ strides_; // in elements
+    std::size_t rows_; // product of all but the innermost extent
+    std::size_t bytesPerRow_;
+
+    static indices_
+    computeStrides(indices_ const& _extents)
+    {
+        auto result = indices_{ };
+        result[Rank - 1] = 1;
+        if constexpr (Rank > 1)
+        {
+            result[Rank - 2] = detail::padded_row_stride(_extents[Rank - 1], sizeof(T), detail::alignment_in_bytes(Alignment | alignof(T)), Padding);
+            for (std::size_t r = Rank - 2; r-- != 0; )
+            {
+                auto strideR = detail::try_multiply_unsigned(result[r + 1], _extents[r + 1]);
+                if (strideR.ec != std::errc{ }) throw std::bad_alloc{ };
+                result[r] = strideR.value;
+            }
+        }
+        return result;
+    }
+    static std::size_t
+    computeRows(indices_ const& _extents)
+    {
+        std::size_t result = 1;
+        for (std::size_t r = 0; r != Rank - 1; ++r)
+        {
+            auto rowsR = detail::try_multiply_unsigned(result, _extents[r]);
+            if (rowsR.ec != std::errc{ }) throw std::bad_alloc{ };
+            result = rowsR.value;
+        }
+        return result;
+    }
+
+    template <typename... Ts>
+    aligned_tensor_buffer(internal_constructor, indices_ const& _extents, allocator_type _allocator, Ts&&... args)
+        : allocator_type(std::move(_allocator)), extents_(_extents), strides_(computeStrides(_extents)), rows_(computeRows(_extents))
+    {
+        auto bytesPerRowR = detail::try_multiply_unsigned(Rank > 1 ? strides_[Rank - 2] : _extents[0], sizeof(T));
+        auto numBytesR = detail::try_multiply_unsigned(rows_, bytesPerRowR.value);
+        if (bytesPerRowR.ec != std::errc{ } || numBytesR.ec != std::errc{ }) throw std::bad_alloc{ };
+        bytesPerRow_ = bytesPerRowR.value;
+
+        if (rows_ == 0 || _extents[Rank - 1] == 0)
+        {
+            data_ = nullptr;
+        }
+        else
+        {
+            auto alloc = byte_allocator_(get_allocator());
+            data_ = std::allocator_traits<byte_allocator_>::allocate(alloc, numBytesR.value);
+
+            std::size_t numElementsConstructed = 0;
+            auto transaction = detail::make_transaction(
+                std::negation<std::is_nothrow_constructible<T, Ts...>>{ },
+                [this, &numElementsConstructed]
+                {
+                    detail::destroy_aligned_row_buffer<T>(data_, get_allocator(), rows_, extents_[Rank - 1], bytesPerRow_, numElementsConstructed);
+                    auto alloc = byte_allocator_(get_allocator());
+                    std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, rows_ * bytesPerRow_);
+                });
+            detail::construct_aligned_row_buffer<T>(data_, get_allocator(), numElementsConstructed, rows_, extents_[Rank - 1], bytesPerRow_,
+                std::is_nothrow_constructible<T, Ts...>{ }, std::forward<Ts>(args)...);
+            transaction.commit();
+        }
+    }
+    void
+    destroy_and_free() noexcept
+    {
+        detail::destroy_aligned_row_buffer<T>(data_, get_allocator(), rows_, extents_[Rank - 1], bytesPerRow_);
+        auto alloc = byte_allocator_(get_allocator());
+        std::allocator_traits<byte_allocator_>::deallocate(alloc, data_, rows_ * bytesPerRow_);
+    }
+
+    T*
+    element(indices_ const& indices) const
+    {
+        std::size_t offset = 0;
+        for (std::size_t r = 0; r != Rank; ++r)
+        {
+            gsl_Expects(indices[r] < extents_[r]);
+            offset += indices[r] * strides_[r];
+        }
+        return reinterpret_cast<T*>(data_) + offset;
+    }
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using reference = T&;
+    using const_reference = T const&;
+
+#if defined(__cpp_lib_mdspan)
+    using mdspan_type = std::mdspan<T, std::dextents<std::size_t, Rank>, std::layout_stride>;
+    using const_mdspan_type = std::mdspan<T const, std::dextents<std::size_t, Rank>, std::layout_stride>;
+#endif // defined(__cpp_lib_mdspan)
+
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    constexpr aligned_tensor_buffer() noexcept
+        : allocator_type{ }, data_(nullptr), extents_{ }, strides_{ }, rows_(0), bytesPerRow_(0)
+    {
+    }
+    aligned_tensor_buffer(allocator_type _alloc) noexcept
+        : allocator_type(std::move(_alloc)), data_(nullptr), extents_{ }, strides_{ }, rows_(0), bytesPerRow_(0)
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_tensor_buffer(std::array<std::size_t, Rank> const& _extents)
+        : aligned_tensor_buffer(internal_constructor{ }, _extents, { })
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit aligned_tensor_buffer(std::array<std::size_t, Rank> const& _extents, T const& _value)
+        : aligned_tensor_buffer(internal_constructor{ }, _extents, { }, _value)
+    {
+    }
+    explicit aligned_tensor_buffer(std::array<std::size_t, Rank> const& _extents, A _alloc)
+        : aligned_tensor_buffer(internal_constructor{ }, _extents, std::move(_alloc))
+    {
+    }
+    explicit aligned_tensor_buffer(std::array<std::size_t, Rank> const& _extents, T const& _value, A _alloc)
+        : aligned_tensor_buffer(internal_constructor{ }, _extents, std::move(_alloc), _value)
+    {
+    }
+
+    constexpr aligned_tensor_buffer(aligned_tensor_buffer&& rhs) noexcept
+        : allocator_type(rhs.get_allocator()),
+          data_(std::exchange(rhs.data_, { })),
+          extents_(std::exchange(rhs.extents_, { })),
+          strides_(std::exchange(rhs.strides_, { })),
+          rows_(std::exchange(rhs.rows_, { })),
+          bytesPerRow_(std::exchange(rhs.bytesPerRow_, { }))
+    {
+    }
+    constexpr aligned_tensor_buffer&
+    operator =(aligned_tensor_buffer&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            if (data_ != nullptr)
+            {
+                destroy_and_free();
+            }
+            static_cast<allocator_type&>(*this) = rhs.get_allocator();
+            data_ = std::exchange(rhs.data_, { });
+            extents_ = std::exchange(rhs.extents_, { });
+            strides_ = std::exchange(rhs.strides_, { });
+            rows_ = std::exchange(rhs.rows_, { });
+            bytesPerRow_ = std::exchange(rhs.bytesPerRow_, { });
+        }
+        return *this;
+    }
+
+    ~aligned_tensor_buffer()
+    {
+        if (data_ != nullptr)
+        {
+            destroy_and_free();
+        }
+    }
+
+    [[nodiscard]] allocator_type
+    get_allocator() const noexcept
+    {
+        return *this;
+    }
+
+    [[nodiscard]] static constexpr std::size_t
+    rank() noexcept
+    {
+        return Rank;
+    }
+    [[nodiscard]] std::array<std::size_t, Rank> const&
+    extents() const noexcept
+    {
+        return extents_;
+    }
+    [[nodiscard]] std::size_t
+    extent(std::size_t r) const
+    {
+        gsl_Expects(r < Rank);
+
+        return extents_[r];
+    }
+
+        //
+        // Distances in elements between adjacent indices of every dimension, as used by `std::layout_stride`.
+        //
+    [[nodiscard]] std::array<std::size_t, Rank> const&
+    strides() const noexcept
+    {
+        return strides_;
+    }
+    [[nodiscard]] std::size_t
+    stride(std::size_t r) const
+    {
+        gsl_Expects(r < Rank);
+
+        return strides_[r];
+    }
+
+        //
+        // Number of elements, excluding padding.
+        //
+    [[nodiscard]] std::size_t
+    size() const noexcept
+    {
+        return rows_ * extents_[Rank - 1];
+    }
+    [[nodiscard]] constexpr bool
+    empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+        //
+        // Pointer to the first element. Element `(i0, ..., in)` is located at `data()[i0*stride(0) + ... + in*stride(n)]`.
+        //
+    [[nodiscard]] T*
+    data() noexcept
+    {
+        return reinterpret_cast<T*>(data_);
+    }
+    [[nodiscard]] T const*
+    data() const noexcept
+    {
+        return reinterpret_cast<T const*>(data_);
+    }
+
+    template <typename... Is>
+        requires (sizeof...(Is) == Rank && (std::is_convertible_v<Is, std::size_t> && ...))
+    [[nodiscard]] reference
+    operator ()(Is... indices)
+    {
+        return *element(indices_{ std::size_t(indices)... });
+    }
+    template <typename... Is>
+        requires (sizeof...(Is) == Rank && (std::is_convertible_v<Is, std::size_t> && ...))
+    [[nodiscard]] const_reference
+    operator ()(Is... indices) const
+    {
+        return *element(indices_{ std::size_t(indices)... });
+    }
+    [[nodiscard]] reference
+    operator [](std::array<std::size_t, Rank> const& indices)
+    {
+        return *element(indices);
+    }
+    [[nodiscard]] const_reference
+    operator [](std::array<std::size_t, Rank> const& indices) const
+    {
+        return *element(indices);
+    }
+
+#if defined(__cpp_lib_mdspan)
+        //
+        // Returns a `std::mdspan<>` with strided layout which refers to the elements of the buffer.
+        //
+    [[nodiscard]] mdspan_type
+    to_mdspan() noexcept
+    {
+        using extents_type = typename mdspan_type::extents_type;
+        return { data(), std::layout_stride::mapping<extents_type>(extents_type(extents_), strides_) };
+    }
+    [[nodiscard]] const_mdspan_type
+    to_mdspan() const noexcept
+    {
+        using extents_type = typename const_mdspan_type::extents_type;
+        return { data(), std::layout_stride::mapping<extents_type>(extents_type(extents_), strides_) };
+    }
+#endif // defined(__cpp_lib_mdspan)
+};
+
+
+    //
+    // Per-thread storage for the threads of a thread squad, with one slot for every thread.
+    //ᅟ
+    //ᅟ    auto counts = per_thread<std::int64_t>(threadSquad);
+    //ᅟ    threadSquad.run([&](thread_squad::task_context& ctx) { ++counts.local(ctx); });
+    //ᅟ    std::int64_t total = counts.combine(threadSquad, 0, std::plus<>{ });
+    //ᅟ
+    // Every slot is constructed by the thread it belongs to, so with a first-touch page placement policy, slots are placed
+    // on the NUMA node of their thread unless they share a memory page with the slot of a thread on another NUMA node.
+    // Slots are aligned to `Alignment`, which defaults to `cache_line_alignment` to avoid false sharing; specify
+    // `page_alignment` to place every slot on a page of its own.
+    //ᅟ
+    // Supports special alignment values such as `cache_line_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+template <typename T, std::size_t Alignment = cache_line_alignment, typename A = aligned_allocator<T, Alignment>>
+class per_thread
+{
+private:
+        // With as many indices as threads, the default static-block schedule has the slot with index `i` constructed by
+        // thread `i`.
+    aligned_buffer<T, Alignment, A> slots_;
+
+public:
+    using allocator_type = typename aligned_buffer<T, Alignment, A>::allocator_type;
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = T const&;
+
+    using iterator = typename aligned_buffer<T, Alignment, A>::iterator;
+    using const_iterator = typename aligned_buffer<T, Alignment, A>::const_iterator;
+
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit per_thread(thread_squad& _threadSquad)
+        : slots_(_threadSquad, std::size_t(_threadSquad.num_threads()))
+    {
+    }
+    template <typename U = int, std::enable_if_t<std::is_default_constructible_v<allocator_type>, U> = 0>
+    explicit per_thread(thread_squad& _threadSquad, T const& _value)
+        : slots_(_threadSquad, std::size_t(_threadSquad.num_threads()), _value)
+    {
+    }
+    explicit per_thread(thread_squad& _threadSquad, A _alloc)
+        : slots_(_threadSquad, std::size_t(_threadSquad.num_threads()), std::move(_alloc))
+    {
+    }
+    explicit per_thread(thread_squad& _threadSquad, T const& _value, A _alloc)
+        : slots_(_threadSquad, std::size_t(_threadSquad.num_threads()), _value, std::move(_alloc))
+    {
+    }
+
+    [[nodiscard]] allocator_type
+    get_allocator() const noexcept
+    {
+        return slots_.get_allocator();
+    }
+
+        //
+        // The number of slots, which equals the number of threads in the thread squad.
+        //
+    [[nodiscard]] std::size_t
+    size() const noexcept
+    {
+        return slots_.size();
+    }
+    [[nodiscard]] reference
+    operator [](std::size_t i)
+    {
+        return slots_[i];
+    }
+    [[nodiscard]] const_reference
+    operator [](std::size_t i) const
+    {
+        return slots_[i];
+    }
+
+        //
+        // The slot of the thread which executes the given task context.
+        //
+    [[nodiscard]] reference
+    local(thread_squad::task_context const& ctx)
+    {
+        return slots_[std::size_t(ctx.thread_index())];
+    }
+    [[nodiscard]] const_reference
+    local(thread_squad::task_context const& ctx) const
+    {
+        return slots_[std::size_t(ctx.thread_index())];
+    }
+
+    [[nodiscard]] iterator
+    begin() noexcept
+    {
+        return slots_.begin();
+    }
+    [[nodiscard]] const_iterator
+    begin() const noexcept
+    {
+        return slots_.begin();
+    }
+    [[nodiscard]] iterator
+    end() noexcept
+    {
+        return slots_.end();
+    }
+    [[nodiscard]] const_iterator
+    end() const noexcept
+    {
+        return slots_.end();
+    }
+
+        //
+        // Invokes `func(slot)` for every slot on the thread the slot belongs to, and waits until all invocations have run to
+        // completion.
+        //ᅟ
+        // `_threadSquad` must be the thread squad with which the object was constructed. If `func` throws an exception,
+        // `std::terminate()` is called.
+        //
+    template <std::invocable<T&> FuncT>
+    requires std::copy_constructible<FuncT>
+    void
+    for_each(thread_squad& _threadSquad, FuncT func)
+    {
+        gsl_Expects(std::size_t(_threadSquad.num_threads()) == slots_.size());
+
+        _threadSquad.run(
+            [this, func = std::move(func)]
+            (thread_squad::task_context& ctx) mutable
+            {
+                func(local(ctx));
+            });
+    }
+
+        //
+        // Reduces the values of all slots with the reduction operation `reduceOp`, which is executed by the threads of the
+        // thread squad along the reduction tree used by `thread_squad::transform_reduce()`.
+        //ᅟ
+        // `_threadSquad` must be the thread squad with which the object was constructed. If `reduceOp` throws an exception,
+        // `std::terminate()` is called.
+        //
+    template <detail::reduction<T> ReduceOpT>
+    requires std::copyable<T> && std::copy_constructible<ReduceOpT>
+    [[nodiscard]] T
+    combine(thread_squad& _threadSquad, T init, ReduceOpT reduceOp) const
+    {
+        gsl_Expects(std::size_t(_threadSquad.num_threads()) == slots_.size());
+
+        return _threadSquad.transform_reduce(
+            [this]
+            (thread_squad::task_context& ctx)
+            {
+                return local(ctx);
+            },
+            std::move(init), std::move(reduceOp));
+    }
 };
 
 
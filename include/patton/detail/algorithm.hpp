@@ -0,0 +1,166 @@
+
+#ifndef INCLUDED_PATTON_DETAIL_ALGORITHM_HPP_
+#define INCLUDED_PATTON_DETAIL_ALGORITHM_HPP_
+
+
+#include <limits>
+#include <cstddef>      // for size_t, ptrdiff_t
+#include <cstdint>      // for int32_t, int64_t
+#include <concepts>     // for same_as<>
+#include <algorithm>    // for min()
+#include <type_traits>  // for is_integral<>, make_unsigned<>
+
+#include <patton/detail/thread_squad.hpp>  // for static_block_range()
+
+
+namespace patton::detail {
+
+
+template <typename T>
+concept simd_arithmetic = std::same_as<T, float> || std::same_as<T, double> || std::same_as<T, std::int32_t> || std::same_as<T, std::int64_t>;
+
+    // Integer arithmetic wraps around on overflow, as it would in a vector register.
+template <simd_arithmetic T>
+constexpr T
+wrapping_add(T lhs, T rhs) noexcept
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        using U = std::make_unsigned_t<T>;
+        return T(U(lhs) + U(rhs));
+    }
+    else
+    {
+        return lhs + rhs;
+    }
+}
+template <simd_arithmetic T>
+constexpr T
+wrapping_multiply(T lhs, T rhs) noexcept
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        using U = std::make_unsigned_t<T>;
+        return T(U(lhs) * U(rhs));
+    }
+    else
+    {
+        return lhs * rhs;
+    }
+}
+
+    // Sequential reduction kernels which use multiple accumulators. The implementation selects the widest instruction set
+    // supported by the processor at runtime.
+template <simd_arithmetic T> [[nodiscard]] T simd_sum(T const* data, std::size_t n) noexcept;
+template <simd_arithmetic T> [[nodiscard]] T simd_min(T const* data, std::size_t n) noexcept;
+template <simd_arithmetic T> [[nodiscard]] T simd_max(T const* data, std::size_t n) noexcept;
+template <simd_arithmetic T> [[nodiscard]] T simd_dot(T const* x, T const* y, std::size_t n) noexcept;
+
+struct sum_reduction
+{
+    template <simd_arithmetic T>
+    static constexpr T
+    identity() noexcept
+    {
+        return T{ };
+    }
+    template <simd_arithmetic T>
+    constexpr T
+    operator ()(T lhs, T rhs) const noexcept
+    {
+        return detail::wrapping_add(lhs, rhs);
+    }
+    template <simd_arithmetic T>
+    static T
+    kernel(T const* data, std::size_t n) noexcept
+    {
+        return detail::simd_sum(data, n);
+    }
+};
+struct min_reduction
+{
+    template <simd_arithmetic T>
+    static constexpr T
+    identity() noexcept
+    {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    }
+    template <simd_arithmetic T>
+    constexpr T
+    operator ()(T lhs, T rhs) const noexcept
+    {
+        return rhs < lhs ? rhs : lhs;
+    }
+    template <simd_arithmetic T>
+    static T
+    kernel(T const* data, std::size_t n) noexcept
+    {
+        return detail::simd_min(data, n);
+    }
+};
+struct max_reduction
+{
+    template <simd_arithmetic T>
+    static constexpr T
+    identity() noexcept
+    {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+    }
+    template <simd_arithmetic T>
+    constexpr T
+    operator ()(T lhs, T rhs) const noexcept
+    {
+        return lhs < rhs ? rhs : lhs;
+    }
+    template <simd_arithmetic T>
+    static T
+    kernel(T const* data, std::size_t n) noexcept
+    {
+        return detail::simd_max(data, n);
+    }
+};
+struct dot_reduction : sum_reduction
+{
+    template <simd_arithmetic T>
+    static T
+    kernel(T const* x, T const* y, std::size_t n) noexcept
+    {
+        return detail::simd_dot(x, y, n);
+    }
+};
+
+    // Minimal number of elements per thread; there is no point in waking threads for less work.
+constexpr std::size_t parallel_reduce_min_block_size = 8192;
+
+template <typename ThreadSquadT, typename ReductionT, simd_arithmetic T, std::same_as<T>... Ts>
+T
+parallel_reduce(ThreadSquadT& threadSquad, ReductionT reduction, int concurrency, std::size_t n, T const* data, Ts const*... moreData)
+{
+    if (concurrency == -1)
+    {
+        concurrency = threadSquad.num_threads();
+    }
+    concurrency = static_cast<int>(std::min<std::size_t>(std::size_t(concurrency),
+        (n + (parallel_reduce_min_block_size - 1))/parallel_reduce_min_block_size));
+
+        // Blocks are partitioned in units of 64 bytes so that, for cache-line-aligned data, every cache line is read by only
+        // one thread.
+    constexpr std::ptrdiff_t elementsPerUnit = 64/sizeof(T);
+    std::ptrdiff_t numUnits = std::ptrdiff_t((n + (elementsPerUnit - 1))/elementsPerUnit);
+    return threadSquad.transform_reduce(
+        [reduction, n, numUnits, data, moreData...]
+        (auto& ctx)
+        {
+            auto [firstUnit, lastUnit] = detail::static_block_range(0, numUnits, ctx.thread_index(), ctx.num_threads());
+            std::size_t first = std::min(std::size_t(firstUnit*elementsPerUnit), n);
+            std::size_t last = std::min(std::size_t(lastUnit*elementsPerUnit), n);
+            return reduction.kernel(data + first, (moreData + first)..., last - first);
+        },
+        reduction.template identity<T>(), reduction, concurrency);
+}
+
+
+} // namespace patton::detail
+
+
+#endif // INCLUDED_PATTON_DETAIL_ALGORITHM_HPP_
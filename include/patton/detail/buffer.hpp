@@ -3,32 +3,160 @@
 #define INCLUDED_PATTON_DETAIL_BUFFER_HPP_
 
 
+#include <new>          // for bad_alloc
+#include <bit>          // for bit_floor()
+#include <tuple>
+#include <limits>
 #include <memory>       // for allocator_traits<>
 #include <compare>
+#include <algorithm>    // for min(), max()
+#include <numeric>      // for lcm()
 #include <cstddef>      // for size_t, ptrdiff_t
+#include <cstdint>      // for uintptr_t
+#include <utility>      // for index_sequence<>
 #include <iterator>     // for input_iterator_tag, output_iterator_tag, random_access_iterator_tag
 #include <type_traits>  // for integral_constant<>, enable_if<>, is_const<>, is_same<>, is_nothrow_default_constructible<>
 
 #include <gsl-lite/gsl-lite.hpp> // for gsl_Expects()
 
+#include <patton/detail/cpuinfo.hpp>     // for data_cache_infos()
+#include <patton/detail/arithmetic.hpp>  // for try_multiply_unsigned(), try_ceili()
+
 
 namespace patton {
 
 namespace gsl = ::gsl_lite;
 
 
+    //
+    // Policies for padding the rows of `aligned_row_buffer<>` and `aligned_tensor_buffer<>` beyond their alignment.
+    //
+enum class row_padding
+{
+        //
+        // Rows are padded only as required by the alignment.
+        //
+    none,
+
+        //
+        // Rows are padded further if the distance between adjacent rows would be a multiple of 4 KiB. On many CPUs, a load and
+        // a store whose addresses differ by a multiple of 4 KiB are falsely considered dependent ("4K aliasing").
+        //
+    avoid_4k_aliasing,
+
+        //
+        // Rows are padded further if the distance between adjacent rows would be a multiple of a critical stride derived from
+        // the cache geometry, such that column-wise traversals do not map to only a few cache sets. Also avoids 4K aliasing.
+        //
+    avoid_cache_aliasing
+};
+
+
 template <typename T, std::size_t Alignment, typename A>
 class aligned_buffer;
 
 template <typename T, std::size_t Alignment, typename A>
+class aligned_vector;
+
+template <typename T, std::size_t Alignment, typename A, row_padding Padding>
 class aligned_row_buffer;
 
+template <typename T, std::size_t Alignment, typename A>
+class aligned_soa_buffer;
+
+template <typename T, std::size_t Rank, std::size_t Alignment, typename A, row_padding Padding>
+class aligned_tensor_buffer;
+
 
 }  // namespace patton
 
 namespace patton::detail {
 
 
+    // Writes to the first byte of every page which begins within the given range of not yet constructed memory, thereby
+    // faulting in the page on the calling thread. `pageSize` must be a power of 2.
+inline void
+first_touch_pages(char* data, std::size_t size, std::size_t pageSize) noexcept
+{
+    auto begin = reinterpret_cast<std::uintptr_t>(data);
+    auto end = begin + size;
+    for (std::uintptr_t p = (begin + pageSize - 1) & ~std::uintptr_t(pageSize - 1); p < end; p += pageSize)
+    {
+        *reinterpret_cast<char volatile*>(p) = 0;
+    }
+}
+
+
+    // Loads and stores whose addresses differ by a multiple of 4 KiB are falsely considered dependent by the memory
+    // disambiguation logic of many CPUs ("4K aliasing").
+constexpr std::size_t aliasing_period = 4096;
+
+    // Addresses which differ by a multiple of the set span `line_size × sets` of a cache map to the same cache set. If the
+    // distance between adjacent rows is a multiple of a large power of 2, a column-wise traversal thus uses only a small
+    // fraction of the cache sets. We consider distances critical if they are a multiple of the L1 set span divided by the
+    // L1 associativity, or of the 4K aliasing period.
+struct cache_aliasing_params
+{
+    std::size_t critical_stride;  // power of 2
+    std::size_t max_set_span;     // padding by a multiple of the largest set span does not change the mapping to cache sets
+};
+inline cache_aliasing_params
+get_cache_aliasing_params() noexcept
+{
+    auto caches = detail::data_cache_infos();
+    if (caches.empty())
+    {
+            // Assume a typical 32 KiB 8-way L1 cache with 64-byte cache lines.
+        return { .critical_stride = 512, .max_set_span = aliasing_period };
+    }
+    auto const& l1 = caches.front();
+    std::size_t l1SetSpan = l1.line_size * l1.sets;
+    std::size_t criticalStride = std::min(std::max(std::bit_floor(l1SetSpan / l1.ways), std::bit_floor(l1.line_size)), aliasing_period);
+    std::size_t maxSetSpan = aliasing_period;
+    for (auto const& cache : caches)
+    {
+        maxSetSpan = std::max(maxSetSpan, cache.line_size * cache.sets);
+    }
+    return { .critical_stride = criticalStride, .max_set_span = maxSetSpan };
+}
+
+    // Returns the distance in bytes between the beginnings of adjacent rows of `rowSize` bytes such that every row begins at
+    // an offset which is a multiple of `granularity`. If the distance would be critical for the given padding policy, the
+    // rows are padded further.
+inline std::size_t
+padded_row_size(std::size_t rowSize, std::size_t granularity, row_padding padding)
+{
+    auto bytesPerRowR = detail::try_ceili(rowSize, granularity);
+    if (bytesPerRowR.ec != std::errc{ }) throw std::bad_alloc{ };
+    std::size_t bytesPerRow = bytesPerRowR.value;
+    if (bytesPerRow == 0 || padding == row_padding::none) return bytesPerRow;
+
+    auto params = padding == row_padding::avoid_cache_aliasing
+        ? detail::get_cache_aliasing_params()
+        : cache_aliasing_params{ .critical_stride = aliasing_period, .max_set_span = aliasing_period };
+    if (granularity % params.max_set_span == 0) return bytesPerRow;  // padding would not change the mapping to cache sets
+    if (bytesPerRow % params.critical_stride == 0
+        && (granularity % params.critical_stride != 0 || (bytesPerRow / granularity) % 2 == 0))
+    {
+            // Padding by the granularity either makes the distance a non-multiple of the critical stride or, if the
+            // granularity is a multiple of the critical stride, an odd multiple of the granularity.
+        if (bytesPerRow > std::numeric_limits<std::size_t>::max() - granularity) throw std::bad_alloc{ };
+        bytesPerRow += granularity;
+    }
+    return bytesPerRow;
+}
+
+    // Returns the distance in elements between the beginnings of adjacent rows of `n` elements of size `elementSize` such
+    // that every row begins at an address aligned to `alignment`, padded as by `padded_row_size()`.
+inline std::size_t
+padded_row_stride(std::size_t n, std::size_t elementSize, std::size_t alignment, row_padding padding)
+{
+    auto rawBytesPerRowR = detail::try_multiply_unsigned(n, elementSize);
+    if (rawBytesPerRowR.ec != std::errc{ }) throw std::bad_alloc{ };
+    return detail::padded_row_size(rawBytesPerRowR.value, std::lcm(elementSize, alignment), padding) / elementSize;
+}
+
+
 template <typename T, typename A, typename... Ts>
 void
 construct_aligned_buffer(char* data, A alloc, std::size_t& numElementsConstructed, std::size_t size, std::size_t bytesPerElement,
@@ -138,6 +266,7 @@ template <typename T>
 class aligned_buffer_iterator
 {
     template <typename, std::size_t, typename> friend class patton::aligned_buffer;
+    template <typename, std::size_t, typename> friend class patton::aligned_vector;
 
 private:
     char* data_;
@@ -416,6 +545,149 @@ public:
 };
 
 
+template <typename... Ts>
+class aligned_soa_buffer_iterator
+{
+    template <typename, std::size_t, typename> friend class patton::aligned_soa_buffer;
+    template <typename...> friend class aligned_soa_buffer_iterator;
+
+private:
+    std::tuple<Ts*...> fields_;
+    std::size_t index_;
+
+    aligned_soa_buffer_iterator(std::tuple<Ts*...> _fields, std::size_t _index)
+        : fields_(_fields), index_(_index)
+    {
+    }
+
+    template <std::size_t... Is>
+    std::tuple<Ts&...>
+    dereference(std::size_t i, std::index_sequence<Is...>) const
+    {
+        return { std::get<Is>(fields_)[i]... };
+    }
+
+public:
+    constexpr aligned_soa_buffer_iterator() noexcept
+        : fields_{ }, index_(0)
+    {
+    }
+
+    aligned_soa_buffer_iterator(aligned_soa_buffer_iterator const&) = default;
+    aligned_soa_buffer_iterator&
+    operator =(aligned_soa_buffer_iterator const&) = default;
+
+    template <typename... Us,
+              std::enable_if_t<(std::is_const<Ts>::value && ...) && (!std::is_const<Us>::value && ...) && std::is_same<std::tuple<Us const...>, std::tuple<Ts...>>::value, int> = 0>
+    aligned_soa_buffer_iterator(aligned_soa_buffer_iterator<Us...> const& rhs) noexcept
+        : fields_(rhs.fields_), index_(rhs.index_)
+    {
+    }
+    template <typename... Us,
+              std::enable_if_t<(std::is_const<Ts>::value && ...) && (!std::is_const<Us>::value && ...) && std::is_same<std::tuple<Us const...>, std::tuple<Ts...>>::value, int> = 0>
+    aligned_soa_buffer_iterator&
+    operator =(aligned_soa_buffer_iterator<Us...> const& rhs) noexcept
+    {
+        fields_ = rhs.fields_;
+        index_ = rhs.index_;
+        return *this;
+    }
+
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = input_output_iterator_tag;
+    using value_type        = std::tuple<std::remove_const_t<Ts>...>;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = std::tuple<Ts&...>;
+
+    bool
+    operator ==(aligned_soa_buffer_iterator const& rhs) const
+    {
+        gsl_Expects(std::get<0>(fields_) == std::get<0>(rhs.fields_));
+
+        return index_ == rhs.index_;
+    }
+    auto
+    operator <=>(aligned_soa_buffer_iterator const& rhs) const
+    {
+        gsl_Expects(std::get<0>(fields_) == std::get<0>(rhs.fields_));
+
+        return index_ <=> rhs.index_;
+    }
+
+    [[nodiscard]] reference
+    operator *() const
+    {
+        return dereference(index_, std::index_sequence_for<Ts...>{ });
+    }
+    aligned_soa_buffer_iterator&
+    operator ++()
+    {
+        ++index_;
+        return *this;
+    }
+    aligned_soa_buffer_iterator&
+    operator --()
+    {
+        --index_;
+        return *this;
+    }
+    aligned_soa_buffer_iterator
+    operator ++(int)
+    {
+        aligned_soa_buffer_iterator result = *this;
+        ++index_;
+        return result;
+    }
+    aligned_soa_buffer_iterator
+    operator --(int)
+    {
+        aligned_soa_buffer_iterator result = *this;
+        --index_;
+        return result;
+    }
+    aligned_soa_buffer_iterator&
+    operator +=(difference_type d)
+    {
+        index_ += d;
+        return *this;
+    }
+    aligned_soa_buffer_iterator
+    operator +(difference_type d) const
+    {
+        aligned_soa_buffer_iterator result = *this;
+        return result += d;
+    }
+    friend aligned_soa_buffer_iterator
+    operator +(difference_type d, aligned_soa_buffer_iterator const& self)
+    {
+        aligned_soa_buffer_iterator result = self;
+        return result += d;
+    }
+    aligned_soa_buffer_iterator&
+    operator -=(difference_type d)
+    {
+        index_ -= d;
+        return *this;
+    }
+    aligned_soa_buffer_iterator
+    operator -(difference_type d) const
+    {
+        aligned_soa_buffer_iterator result = *this;
+        return result -= d;
+    }
+    difference_type
+    operator -(aligned_soa_buffer_iterator const& rhs) const
+    {
+        return index_ - rhs.index_;
+    }
+    reference
+    operator [](difference_type d) const
+    {
+        return dereference(index_ + d, std::index_sequence_for<Ts...>{ });
+    }
+};
+
+
 } // namespace patton::detail
 
 
@@ -0,0 +1,48 @@
+
+#ifndef INCLUDED_PATTON_DETAIL_CPUINFO_HPP_
+#define INCLUDED_PATTON_DETAIL_CPUINFO_HPP_
+
+
+#include <span>
+#include <cstddef>  // for size_t
+
+
+namespace patton::detail {
+
+
+struct hardware_thread_info
+{
+    int id;        // hardware thread id as used for thread affinity
+    int node;      // dense NUMA node index
+    int package;   // physical package ("socket") id
+    int core;      // core id, unique only within the package
+    int llc;       // id of the first hardware thread sharing the last-level cache, or -1 if unknown
+    int smt_rank;  // rank of the hardware thread among the hardware threads of its core
+};
+
+struct cache_info
+{
+    int level;
+    std::size_t line_size;  // in bytes
+    std::size_t sets;       // number of sets
+    std::size_t ways;       // associativity
+};
+
+    // Returns topology information for all known hardware threads, ordered by id.
+[[nodiscard]] std::span<hardware_thread_info const>
+hardware_thread_infos() noexcept;
+
+    // Returns the operating system's id of the NUMA node with the given dense node index.
+[[nodiscard]] int
+numa_node_os_id(int node) noexcept;
+
+    // Returns the geometry of the data and unified caches of the first hardware thread, ordered by level, or an empty range
+    // if the cache geometry cannot be determined.
+[[nodiscard]] std::span<cache_info const>
+data_cache_infos() noexcept;
+
+
+} // namespace patton::detail
+
+
+#endif // INCLUDED_PATTON_DETAIL_CPUINFO_HPP_
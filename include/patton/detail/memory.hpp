@@ -36,6 +36,11 @@ template <typename A, typename = void> struct has_member_provides_static_alignme
 template <typename A> struct has_member_provides_static_alignment<A, std::void_t<decltype(A::provides_static_alignment(std::declval<std::size_t>()))>>
     : std::is_convertible<decltype(A::provides_static_alignment(std::declval<std::size_t>())), bool> { };
 
+template <typename A, typename = void> struct has_member_reallocate : std::false_type { };
+template <typename A> struct has_member_reallocate<A, std::void_t<decltype(std::declval<A&>().reallocate(
+    std::declval<typename std::allocator_traits<A>::pointer>(), std::declval<std::size_t>(), std::declval<std::size_t>()))>>
+    : std::true_type { };
+
 
 std::size_t
 constexpr floor_2p(std::size_t x)
@@ -172,14 +177,37 @@ void
 aligned_free(void* data, std::size_t size, std::size_t alignment) noexcept;
 
 void*
-large_page_alloc(std::size_t size);
+large_page_alloc(std::size_t size, bool populate = false);
 void
 large_page_free(void* data, std::size_t size) noexcept;
 
 void*
-page_alloc(std::size_t size);
+explicit_large_page_alloc(std::size_t size, std::size_t pageSize, bool populate = false);
+void
+explicit_large_page_free(void* data, std::size_t size, std::size_t pageSize) noexcept;
+
+void*
+page_alloc(std::size_t size, bool populate = false);
 void
 page_free(void* data, std::size_t size) noexcept;
+    // Resizes an allocation obtained from `page_alloc()`, preserving its contents up to the lesser of the two sizes.
+    // The allocation may be moved. If the allocation cannot be resized, the original allocation remains valid.
+[[nodiscard]] void*
+page_realloc(void* data, std::size_t oldSize, std::size_t newSize, bool populate = false);
+
+void*
+numa_page_alloc(std::size_t size, int node);
+
+class block_pool;
+
+    // Returns the pool for blocks of the given size and alignment, which lives until the end of the program.
+[[nodiscard]] block_pool&
+get_block_pool(std::size_t blockSize, std::size_t alignment);
+
+[[nodiscard]] void*
+block_pool_alloc(block_pool& pool);
+void
+block_pool_free(block_pool& pool, void* block) noexcept;
 
 
 template <typename T, std::size_t Alignment, typename A, bool NeedAlignment>
@@ -189,6 +217,11 @@ class aligned_allocator_adaptor_base<T, Alignment, A, true> : public A
 {
 public:
     using A::A;
+    aligned_allocator_adaptor_base() = default;
+    explicit aligned_allocator_adaptor_base(A const& _alloc)
+        : A(_alloc)
+    {
+    }
 
     [[nodiscard]] bool
     static constexpr provides_static_alignment(std::size_t a) noexcept
@@ -239,12 +272,21 @@ public:
         auto byteAllocator = ByteAllocator(*this); // may not throw
         std::allocator_traits<ByteAllocator>::deallocate(byteAllocator, static_cast<char*>(mem), nbAlloc);
     }
+
+        // Hides `A::reallocate()`, if any, which would not account for the padding of the aligned allocation.
+    void
+    reallocate() = delete;
 };
 template <typename T, std::size_t Alignment, typename A>
 class aligned_allocator_adaptor_base<T, Alignment, A, false> : public A
 {
 public:
     using A::A;
+    aligned_allocator_adaptor_base() = default;
+    explicit aligned_allocator_adaptor_base(A const& _alloc)
+        : A(_alloc)
+    {
+    }
 };
 
 
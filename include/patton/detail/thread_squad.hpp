@@ -3,9 +3,12 @@
 #define INCLUDED_PATTON_DETAIL_THREAD_SQUAD_HPP_
 
 
+#include <atomic>
 #include <memory>       // for unique_ptr<>
+#include <cstddef>      // for ptrdiff_t
 #include <optional>
 #include <concepts>
+#include <algorithm>    // for min(), max()
 #include <type_traits>  // for invoke_result<>
 
 
@@ -67,7 +70,7 @@ static constexpr std::size_t destructive_interference_size = 1024;
 # pragma warning(disable: 4324)  // structure was padded due to alignment specifier
 #endif // _MSC_VER
 template <typename TaskContextT, typename ActionT>
-class alignas(destructive_interference_size) thread_squad_action : public thread_squad_task
+class alignas(destructive_interference_size) thread_squad_action final : public thread_squad_task
 {
 private:
     ActionT action_;
@@ -88,6 +91,15 @@ public:
     }
 };
 
+using thread_squad_task_deleter = void (*)(thread_squad_task* task) noexcept;
+
+template <typename TaskT>
+void
+delete_task(thread_squad_task* task) noexcept
+{
+    delete static_cast<TaskT*>(task);
+}
+
 template <typename T>
 struct alignas(destructive_interference_size) thread_reduce_data
 {
@@ -133,6 +145,97 @@ public:
 };
 
 
+struct alignas(destructive_interference_size) loop_counter
+{
+    std::atomic<std::ptrdiff_t> next;
+};
+
+struct index_range
+{
+    std::ptrdiff_t first;
+    std::ptrdiff_t last;
+};
+
+constexpr index_range
+static_block_range(std::ptrdiff_t first, std::ptrdiff_t last, int i, int n) noexcept
+{
+        // Distribute the remainder among the first threads so that block sizes differ by at most one index.
+    std::ptrdiff_t count = last - first;
+    std::ptrdiff_t blockSize = count / n;
+    std::ptrdiff_t remainder = count % n;
+    std::ptrdiff_t blockFirst = first + i*blockSize + std::min<std::ptrdiff_t>(i, remainder);
+    std::ptrdiff_t blockLast = blockFirst + blockSize + (i < remainder ? 1 : 0);
+    return { blockFirst, blockLast };
+}
+
+template <typename BodyT>
+void
+for_each_index_static_block(BodyT& body, std::ptrdiff_t first, std::ptrdiff_t last, int i, int n)
+{
+    auto [blockFirst, blockLast] = static_block_range(first, last, i, n);
+    for (std::ptrdiff_t j = blockFirst; j != blockLast; ++j)
+    {
+        body(j);
+    }
+}
+
+template <typename BodyT>
+void
+for_each_index_static_cyclic(BodyT& body, std::ptrdiff_t first, std::ptrdiff_t last, std::ptrdiff_t chunkSize, int i, int n)
+{
+    std::ptrdiff_t stride = n*chunkSize;
+    for (std::ptrdiff_t chunkFirst = first + i*chunkSize; chunkFirst < last; )
+    {
+        std::ptrdiff_t chunkLast = chunkFirst + std::min(chunkSize, last - chunkFirst);
+        for (std::ptrdiff_t j = chunkFirst; j != chunkLast; ++j)
+        {
+            body(j);
+        }
+        if (last - chunkFirst <= stride) break;  // avoid overflow
+        chunkFirst += stride;
+    }
+}
+
+template <typename BodyT>
+void
+for_each_index_chunked(BodyT& body, std::ptrdiff_t last, std::ptrdiff_t chunkSize, loop_counter& counter)
+{
+    while (counter.next.load(std::memory_order_relaxed) < last)
+    {
+        std::ptrdiff_t chunkFirst = counter.next.fetch_add(chunkSize, std::memory_order_relaxed);
+        if (chunkFirst >= last) break;
+        std::ptrdiff_t chunkLast = chunkFirst + std::min(chunkSize, last - chunkFirst);
+        for (std::ptrdiff_t j = chunkFirst; j != chunkLast; ++j)
+        {
+            body(j);
+        }
+    }
+}
+
+template <typename BodyT>
+void
+for_each_index_guided(BodyT& body, std::ptrdiff_t last, std::ptrdiff_t minChunkSize, int n, loop_counter& counter)
+{
+    std::ptrdiff_t chunkFirst = counter.next.load(std::memory_order_relaxed);
+    while (chunkFirst < last)
+    {
+            // As with OpenMP's "guided" schedule, the chunk size is proportional to the number of remaining indices divided
+            // by the number of threads.
+        std::ptrdiff_t remaining = last - chunkFirst;
+        std::ptrdiff_t chunkSize = std::min(std::max(minChunkSize, (remaining + (n - 1))/n), remaining);
+        std::ptrdiff_t chunkLast = chunkFirst + chunkSize;
+        if (counter.next.compare_exchange_weak(chunkFirst, chunkLast, std::memory_order_relaxed))
+        {
+            for (std::ptrdiff_t j = chunkFirst; j != chunkLast; ++j)
+            {
+                body(j);
+            }
+            chunkFirst = counter.next.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
 struct task_context_synchronizer
 {
 public:
@@ -6,10 +6,11 @@
 #include <new>          // for align_val_t, bad_alloc
 #include <limits>
 #include <cstddef>      // for size_t, ptrdiff_t, max_align_t
+#include <cstdint>      // for uintptr_t
 #include <cstdlib>      // for calloc(), free()
 #include <cstring>      // for memcpy()
 #include <memory>       // for unique_ptr<>, allocator<>, allocator_traits<>, align()
-#include <utility>      // for forward<>()
+#include <utility>      // for forward<>(), exchange()
 #include <type_traits>  // for is_nothrow_default_constructible<>, enable_if<>, is_same<>, remove_cv<>
 
 #include <gsl-lite/gsl-lite.hpp>  // for gsl_Expects()
@@ -231,12 +232,46 @@ operator ==(aligned_allocator<T, Alignment>, aligned_allocator<U, Alignment>) no
 }
 
 
+    //
+    // Options for allocators which obtain page-granular allocations directly from the operating system.
+    //
+enum class page_options : unsigned
+{
+        //
+        // Pages are faulted in lazily when they are first accessed.
+        //
+    none     = 0,
+
+        //
+        // All pages are faulted in by the allocating thread before the allocation is returned.
+        //ᅟ
+        // This moves the cost of page faults out of the first pass over the data. Note that eagerly populated pages are placed
+        // on the NUMA node of the allocating thread.
+        //
+    populate = 1
+};
+
+
+    //
+    // Faults in all memory pages overlapping the given range, making them writable, such that subsequent accesses do not
+    // incur page faults.
+    //ᅟ
+    // The contents of the memory range are not modified. On Linux, uses `madvise(MADV_POPULATE_WRITE)` if supported by the
+    // kernel, and touches every page otherwise.
+    //
+void
+prefault_pages(void* data, std::size_t size);
+
+
     //
     // Obtains page-granular allocations directly from the operating system.
     //ᅟ
     // On Linux, transparent huge pages are suppressed for allocations made by this allocator.
+    // With `page_options::populate`, all pages are faulted in before the allocation is returned.
+    //ᅟ
+    // Allocations can be resized with `reallocate()`, which may move the allocation but does not copy its contents on Linux.
     //
-template <typename T>
+template <typename T, page_options Options = page_options::none>
 class page_allocator
 {
 public:
@@ -245,14 +280,14 @@ public:
     template <typename U>
     struct rebind
     {
-        using other = page_allocator<U>;
+        using other = page_allocator<U, Options>;
     };
 
     constexpr page_allocator() noexcept
     {
     }
     template <typename U>
-    constexpr page_allocator(page_allocator<U> const&) noexcept
+    constexpr page_allocator(page_allocator<U, Options> const&) noexcept
     {
     }
 
@@ -267,7 +302,7 @@ public:
     {
         if (n >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
         std::size_t nbData = n * sizeof(T);
-        return static_cast<T*>(detail::page_alloc(nbData));
+        return static_cast<T*>(detail::page_alloc(nbData, Options == page_options::populate));
     }
     void
     deallocate(T* ptr, std::size_t n) noexcept
@@ -275,24 +310,122 @@ public:
         std::size_t nbData = n * sizeof(T); // cannot overflow due to preceding check in allocate()
         detail::page_free(ptr, nbData);
     }
+
+        //
+        // Resizes an allocation of `n` elements to `newN` elements, preserving the object representation of the first
+        // `min(n, newN)` elements. The allocation may be moved, so this is suitable only for trivially copyable types.
+        // If an exception is thrown, the original allocation remains valid.
+        //
+    [[nodiscard]] T*
+    reallocate(T* ptr, std::size_t n, std::size_t newN)
+    {
+        if (newN >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
+        std::size_t nbData = n * sizeof(T); // cannot overflow due to preceding check in allocate()
+        std::size_t newNbData = newN * sizeof(T);
+        return static_cast<T*>(detail::page_realloc(ptr, nbData, newNbData, Options == page_options::populate));
+    }
 };
 
-template <typename T, typename U>
+template <typename T, typename U, page_options Options>
 [[nodiscard]] bool
-operator ==(page_allocator<T>, page_allocator<U>) noexcept
+operator ==(page_allocator<T, Options>, page_allocator<U, Options>) noexcept
 {
     return true;
 }
 
 
+    //
+    // Node index which instructs `numa_allocator<>` to interleave allocations across all NUMA nodes.
+    //
+constexpr int numa_interleaved = -1;
+
+    //
+    // Obtains page-granular allocations directly from the operating system and binds them to the given NUMA node, or
+    // interleaves them page-wise across all NUMA nodes.
+    //ᅟ
+    // Node indices are dense and correspond to the node indices used by `numa_node_count()` and related functions.
+    // Binding is best-effort: if the operating system does not support NUMA memory policies, allocations remain unbound.
+    // On Linux, transparent huge pages are suppressed for allocations made by this allocator.
+    //
+template <typename T>
+class numa_allocator
+{
+    template <typename U> friend class numa_allocator;
+
+private:
+    int node_;
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = numa_allocator<U>;
+    };
+
+    constexpr numa_allocator() noexcept
+        : node_(numa_interleaved)
+    {
+    }
+    explicit constexpr numa_allocator(int _node) noexcept
+        : node_(_node)
+    {
+        gsl_Expects(_node >= 0 || _node == numa_interleaved);
+    }
+    template <typename U>
+    constexpr numa_allocator(numa_allocator<U> const& rhs) noexcept
+        : node_(rhs.node_)
+    {
+    }
+
+        //
+        // Returns the NUMA node index allocations are bound to, or `numa_interleaved` if allocations are interleaved.
+        //
+    [[nodiscard]] constexpr int
+    node() const noexcept
+    {
+        return node_;
+    }
+
+    [[nodiscard]] bool
+    static constexpr provides_static_alignment(std::size_t a) noexcept
+    {
+        return patton::provides_static_alignment(page_alignment, a);
+    }
+
+    [[nodiscard]] T*
+    allocate(std::size_t n)
+    {
+        if (n >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
+        std::size_t nbData = n * sizeof(T);
+        return static_cast<T*>(detail::numa_page_alloc(nbData, node_));
+    }
+    void
+    deallocate(T* ptr, std::size_t n) noexcept
+    {
+        std::size_t nbData = n * sizeof(T); // cannot overflow due to preceding check in allocate()
+        detail::page_free(ptr, nbData);
+    }
+};
+
+template <typename T, typename U>
+[[nodiscard]] constexpr bool
+operator ==(numa_allocator<T> const& lhs, numa_allocator<U> const& rhs) noexcept
+{
+    return lhs.node() == rhs.node();
+}
+
+
     //
     // Large page allocator.
     //ᅟ
     // Uses transparent huge pages on Linux and explicit large page allocation on Windows.
     // Note that processes on Windows need to obtain SeLockMemoryPrivilege in order to use large pages,
     // cf. https://docs.microsoft.com/en-us/windows/win32/memory/large-page-support.
+    // With `page_options::populate`, all pages are faulted in before the allocation is returned.
     //
-template <typename T>
+template <typename T, page_options Options = page_options::none>
 class large_page_allocator
 {
 public:
@@ -301,14 +434,14 @@ public:
     template <typename U>
     struct rebind
     {
-        using other = large_page_allocator<U>;
+        using other = large_page_allocator<U, Options>;
     };
 
     constexpr large_page_allocator() noexcept
     {
     }
     template <typename U>
-    constexpr large_page_allocator(large_page_allocator<U> const&) noexcept
+    constexpr large_page_allocator(large_page_allocator<U, Options> const&) noexcept
     {
     }
 
@@ -325,7 +458,7 @@ public:
     {
         if (n >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
         std::size_t nbData = n * sizeof(T);
-        return static_cast<T*>(detail::large_page_alloc(nbData));
+        return static_cast<T*>(detail::large_page_alloc(nbData, Options == page_options::populate));
     }
     void
     deallocate(T* ptr, std::size_t n) noexcept
@@ -335,14 +468,343 @@ public:
     }
 };
 
-template <typename T, typename U>
+template <typename T, typename U, page_options Options>
 [[nodiscard]] bool
-operator ==(large_page_allocator<T>, large_page_allocator<U>) noexcept
+operator ==(large_page_allocator<T, Options>, large_page_allocator<U, Options>) noexcept
 {
     return true;
 }
 
 
+    //
+    // Explicit large page allocator.
+    //ᅟ
+    // Unlike `large_page_allocator<>`, which relies on transparent huge pages on Linux, this allocator obtains memory from the
+    // pool of explicitly reserved large pages (`MAP_HUGETLB`), so allocations are guaranteed to be backed by large pages of
+    // the requested size. `PageSize` must be one of the sizes reported by `hardware_large_page_sizes()`, or 0 to use the
+    // default large page size `hardware_large_page_size()`.
+    // Throws `std::bad_alloc` if not enough large pages are available, and `std::system_error` if the page size is not supported.
+    // On Windows, only the default large page size is supported.
+    // With `page_options::populate`, all pages are faulted in before the allocation is returned.
+    //
+template <typename T, std::size_t PageSize = 0, page_options Options = page_options::none>
+class explicit_large_page_allocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = explicit_large_page_allocator<U, PageSize, Options>;
+    };
+
+    constexpr explicit_large_page_allocator() noexcept
+    {
+    }
+    template <typename U>
+    constexpr explicit_large_page_allocator(explicit_large_page_allocator<U, PageSize, Options> const&) noexcept
+    {
+    }
+
+    [[nodiscard]] bool
+    static constexpr provides_static_alignment(std::size_t a) noexcept
+    {
+            // Explicit large page mappings are aligned to the large page size.
+        return patton::provides_static_alignment(PageSize == 0 ? large_page_alignment : (PageSize | page_alignment), a);
+    }
+
+    [[nodiscard]] T*
+    allocate(std::size_t n)
+    {
+        if (n >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
+        std::size_t nbData = n * sizeof(T);
+        return static_cast<T*>(detail::explicit_large_page_alloc(nbData, PageSize, Options == page_options::populate));
+    }
+    void
+    deallocate(T* ptr, std::size_t n) noexcept
+    {
+        std::size_t nbData = n * sizeof(T); // cannot overflow due to preceding check in allocate()
+        detail::explicit_large_page_free(ptr, nbData, PageSize);
+    }
+};
+
+template <typename T, typename U, std::size_t PageSize, page_options Options>
+[[nodiscard]] bool
+operator ==(explicit_large_page_allocator<T, PageSize, Options>, explicit_large_page_allocator<U, PageSize, Options>) noexcept
+{
+    return true;
+}
+
+
+    //
+    // Reports how many bytes of the given memory range are backed by large pages.
+    //ᅟ
+    // This can be used to verify whether the hint given by `large_page_allocator<>` was honored. Memory which has not been
+    // touched yet is usually not backed by any pages. For transparent huge pages, the result is exact only if the range
+    // spans entire mappings. Throws `std::system_error` if the information is not available on the current platform.
+    //
+[[nodiscard]] std::size_t
+large_page_backed_size(void const* data, std::size_t size);
+
+
+    //
+    // Allocator which serves single-object allocations from a pool of fixed-size blocks.
+    //ᅟ
+    // Blocks are carved from page-granular slabs and kept in per-thread free lists, which exchange batches of blocks with a
+    // shared depot, so allocation and deallocation usually amount to a pointer pop or push. Blocks may be deallocated by a
+    // thread other than the one which allocated them. Memory held by the pool is not returned to the operating system.
+    // Allocations of more than one object are served by global `operator new()` with `std::align_val_t`.
+    //ᅟ
+    // Supports the special alignment values `cache_line_alignment` and `page_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+template <typename T, std::size_t Alignment = alignof(T)>
+class pool_allocator
+{
+    static_assert((Alignment & large_page_alignment) == 0, "pool_allocator<> does not support large page alignment");
+
+private:
+    static detail::block_pool&
+    pool()
+    {
+        static detail::block_pool& pool = []() -> detail::block_pool&
+        {
+                // Free blocks store a pointer, so blocks must be large enough and suitably aligned for it.
+            std::size_t a = detail::alignment_in_bytes(Alignment | alignof(T) | alignof(void*));
+            std::size_t blockSize = sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T);
+            blockSize = (blockSize + (a - 1)) & ~(a - 1);
+            return detail::get_block_pool(blockSize, a);
+        }();
+        return pool;
+    }
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = pool_allocator<U, Alignment>;
+    };
+
+    constexpr pool_allocator() noexcept
+    {
+    }
+    template <typename U>
+    constexpr pool_allocator(pool_allocator<U, Alignment> const&) noexcept
+    {
+    }
+
+    [[nodiscard]] bool
+    static constexpr provides_static_alignment(std::size_t a) noexcept
+    {
+        return patton::provides_static_alignment(Alignment | alignof(T), a);
+    }
+
+    [[nodiscard]] T*
+    allocate(std::size_t n)
+    {
+        if (n == 1)
+        {
+            return static_cast<T*>(detail::block_pool_alloc(pool()));
+        }
+        std::size_t a = detail::alignment_in_bytes(Alignment | alignof(T));
+        if (n >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
+        std::size_t nbData = n * sizeof(T);
+        return static_cast<T*>(detail::aligned_alloc(nbData, a));
+    }
+    void
+    deallocate(T* ptr, std::size_t n) noexcept
+    {
+        if (n == 1)
+        {
+            detail::block_pool_free(pool(), ptr);
+            return;
+        }
+        std::size_t a = detail::alignment_in_bytes(Alignment | alignof(T));
+        std::size_t nbData = n * sizeof(T); // cannot overflow due to preceding check in allocate()
+        detail::aligned_free(ptr, nbData, a);
+    }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+[[nodiscard]] bool
+operator ==(pool_allocator<T, Alignment>, pool_allocator<U, Alignment>) noexcept
+{
+    return true;
+}
+
+
+    //
+    // Memory arena which serves allocations by advancing a pointer into a fixed memory region.
+    //ᅟ
+    // Deallocation is a no-op unless the most recent allocation is released, in which case its memory is reclaimed.
+    // All allocations are released at once by calling `reset()`. Allocations which do not fit into the remaining memory region
+    // are served by global `operator new()`. An arena does not own its memory region, and it is not thread-safe.
+    //
+class arena
+{
+private:
+    char* begin_;
+    char* end_;
+    char* next_;
+
+public:
+    constexpr arena() noexcept
+        : begin_(nullptr), end_(nullptr), next_(nullptr)
+    {
+    }
+    arena(void* _data, std::size_t _size) noexcept
+        : begin_(static_cast<char*>(_data)), end_(begin_ + _size), next_(begin_)
+    {
+    }
+
+    arena(arena&& rhs) noexcept
+        : begin_(std::exchange(rhs.begin_, nullptr)), end_(std::exchange(rhs.end_, nullptr)), next_(std::exchange(rhs.next_, nullptr))
+    {
+    }
+    arena&
+    operator =(arena&& rhs) noexcept
+    {
+        begin_ = std::exchange(rhs.begin_, nullptr);
+        end_ = std::exchange(rhs.end_, nullptr);
+        next_ = std::exchange(rhs.next_, nullptr);
+        return *this;
+    }
+
+        //
+        // The size of the arena's memory region in bytes.
+        //
+    [[nodiscard]] std::size_t
+    capacity() const noexcept
+    {
+        return std::size_t(end_ - begin_);
+    }
+
+        //
+        // The number of bytes of the arena's memory region currently in use.
+        //
+    [[nodiscard]] std::size_t
+    size() const noexcept
+    {
+        return std::size_t(next_ - begin_);
+    }
+
+    [[nodiscard]] void*
+    allocate(std::size_t size, std::size_t alignment)
+    {
+        gsl_Expects(detail::is_alignment_power_of_2(alignment));
+
+        std::size_t padding = std::size_t(-reinterpret_cast<std::uintptr_t>(next_)) & (alignment - 1);
+        std::size_t remaining = std::size_t(end_ - next_);
+        if (size != 0 && padding <= remaining && size <= remaining - padding)
+        {
+            char* result = next_ + padding;
+            next_ = result + size;
+            return result;
+        }
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+    void
+    deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+    {
+        auto p = reinterpret_cast<std::uintptr_t>(ptr);
+        if (p >= reinterpret_cast<std::uintptr_t>(begin_) && p < reinterpret_cast<std::uintptr_t>(end_))
+        {
+            if (static_cast<char*>(ptr) + size == next_)
+            {
+                next_ = static_cast<char*>(ptr);
+            }
+        }
+        else
+        {
+            ::operator delete(ptr, size, std::align_val_t(alignment));
+        }
+    }
+
+        //
+        // Releases all allocations made from the arena's memory region.
+        //
+    void
+    reset() noexcept
+    {
+        next_ = begin_;
+    }
+};
+
+
+    //
+    // Allocator which serves allocations from an `arena`.
+    //ᅟ
+    // Allocations must not outlive the arena's next `reset()`. Thread squads provide a per-thread arena to tasks, cf.
+    // `thread_squad::task_context::arena()`.
+    //
+template <typename T>
+class arena_allocator
+{
+    template <typename U> friend class arena_allocator;
+
+private:
+    patton::arena* arena_;
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = arena_allocator<U>;
+    };
+
+    explicit constexpr arena_allocator(patton::arena& _arena) noexcept
+        : arena_(&_arena)
+    {
+    }
+    template <typename U>
+    constexpr arena_allocator(arena_allocator<U> const& rhs) noexcept
+        : arena_(rhs.arena_)
+    {
+    }
+
+        //
+        // The arena allocations are served from.
+        //
+    [[nodiscard]] constexpr patton::arena&
+    arena() const noexcept
+    {
+        return *arena_;
+    }
+
+    [[nodiscard]] bool
+    static constexpr provides_static_alignment(std::size_t a) noexcept
+    {
+        return patton::provides_static_alignment(alignof(T), a);
+    }
+
+    [[nodiscard]] T*
+    allocate(std::size_t n)
+    {
+        if (n >= std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_alloc{ }; // overflow
+        std::size_t nbData = n * sizeof(T);
+        return static_cast<T*>(arena_->allocate(nbData, alignof(T)));
+    }
+    void
+    deallocate(T* ptr, std::size_t n) noexcept
+    {
+        std::size_t nbData = n * sizeof(T); // cannot overflow due to preceding check in allocate()
+        arena_->deallocate(ptr, nbData, alignof(T));
+    }
+};
+
+template <typename T, typename U>
+[[nodiscard]] constexpr bool
+operator ==(arena_allocator<T> const& lhs, arena_allocator<U> const& rhs) noexcept
+{
+    return &lhs.arena() == &rhs.arena();
+}
+
+
     //
     // Allocator adaptor that aligns memory allocations for the given alignment.
     //ᅟ
@@ -356,6 +818,11 @@ class aligned_allocator_adaptor : public detail::aligned_allocator_adaptor_base<
 
 public:
     using base::base;
+    aligned_allocator_adaptor() = default;
+    aligned_allocator_adaptor(A const& _alloc)  // inherited constructors cannot convert from the base class `A`
+        : base(_alloc)
+    {
+    }
 
     template <typename U>
     struct rebind
@@ -0,0 +1,176 @@
+
+#ifndef INCLUDED_PATTON_MEMORY_RESOURCE_HPP_
+#define INCLUDED_PATTON_MEMORY_RESOURCE_HPP_
+
+
+#include <cstddef>          // for size_t
+#include <memory_resource>  // for pmr::memory_resource, pmr::get_default_resource()
+
+#include <patton/memory.hpp>  // for page_options, cache_line_alignment
+
+
+namespace patton {
+
+
+    //
+    // Memory resource which obtains allocations from global `operator new()` with `std::align_val_t`, aligning every
+    // allocation for at least the given alignment.
+    //ᅟ
+    // Supports special alignment values such as `cache_line_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+class aligned_memory_resource : public std::pmr::memory_resource
+{
+private:
+    std::size_t alignment_;
+
+public:
+    explicit aligned_memory_resource(std::size_t _alignment = cache_line_alignment) noexcept
+        : alignment_(_alignment)
+    {
+    }
+
+        //
+        // The minimal alignment of all allocations.
+        //
+    [[nodiscard]] std::size_t
+    alignment() const noexcept
+    {
+        return alignment_;
+    }
+
+protected:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void
+    do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    bool
+    do_is_equal(std::pmr::memory_resource const& rhs) const noexcept override;
+};
+
+
+    //
+    // Memory resource which obtains page-granular allocations directly from the operating system.
+    //ᅟ
+    // Every allocation is page-aligned; larger alignments are not supported. On Linux, transparent huge pages are suppressed
+    // for allocations made by this resource. With `page_options::populate`, all pages are faulted in before the allocation
+    // is returned.
+    //
+class page_memory_resource : public std::pmr::memory_resource
+{
+private:
+    page_options options_;
+
+public:
+    explicit page_memory_resource(page_options _options = page_options::none) noexcept
+        : options_(_options)
+    {
+    }
+
+protected:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void
+    do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    bool
+    do_is_equal(std::pmr::memory_resource const& rhs) const noexcept override;
+};
+
+
+    //
+    // Memory resource which obtains large-page allocations directly from the operating system.
+    //ᅟ
+    // Uses transparent huge pages on Linux and explicit large page allocation on Windows, cf. `large_page_allocator<>`.
+    // Every allocation is page-aligned; larger alignments are not supported. With `page_options::populate`, all pages are
+    // faulted in before the allocation is returned.
+    //
+class large_page_memory_resource : public std::pmr::memory_resource
+{
+private:
+    page_options options_;
+
+public:
+    explicit large_page_memory_resource(page_options _options = page_options::none) noexcept
+        : options_(_options)
+    {
+    }
+
+protected:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void
+    do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    bool
+    do_is_equal(std::pmr::memory_resource const& rhs) const noexcept override;
+};
+
+
+    //
+    // Memory resource which serves allocations by advancing a pointer into chunks of memory obtained from an upstream
+    // resource, aligning every allocation for at least the given alignment.
+    //ᅟ
+    // Like `std::pmr::monotonic_buffer_resource`, deallocation is a no-op, and memory is released only when `release()` is
+    // called or when the resource is destroyed. Chunk sizes grow geometrically, so in combination with `page_memory_resource`
+    // or `large_page_memory_resource` as upstream resource, system calls are amortized over many allocations.
+    //ᅟ
+    // Supports special alignment values such as `cache_line_alignment`.
+    // Multiple alignment requirements can be combined using bitmask operations, e.g. `cache_line_alignment | alignof(T)`.
+    //
+class aligned_monotonic_buffer_resource : public std::pmr::memory_resource
+{
+private:
+    struct chunk_header;
+
+    std::pmr::memory_resource* upstream_;
+    std::size_t alignment_;
+    std::size_t nextChunkSize_;
+    chunk_header* chunks_;
+    char* next_;
+    char* end_;
+
+public:
+    explicit aligned_monotonic_buffer_resource(std::size_t _alignment = cache_line_alignment,
+        std::size_t _initialSize = 65536, std::pmr::memory_resource* _upstream = std::pmr::get_default_resource()) noexcept;
+    ~aligned_monotonic_buffer_resource();
+
+    aligned_monotonic_buffer_resource(aligned_monotonic_buffer_resource const&) = delete;
+    aligned_monotonic_buffer_resource& operator =(aligned_monotonic_buffer_resource const&) = delete;
+
+        //
+        // Returns all memory to the upstream resource.
+        //
+    void
+    release() noexcept;
+
+        //
+        // The upstream resource from which chunks of memory are obtained.
+        //
+    [[nodiscard]] std::pmr::memory_resource*
+    upstream_resource() const noexcept
+    {
+        return upstream_;
+    }
+
+        //
+        // The minimal alignment of all allocations.
+        //
+    [[nodiscard]] std::size_t
+    alignment() const noexcept
+    {
+        return alignment_;
+    }
+
+protected:
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void
+    do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    bool
+    do_is_equal(std::pmr::memory_resource const& rhs) const noexcept override;
+};
+
+
+} // namespace patton
+
+
+#endif // INCLUDED_PATTON_MEMORY_RESOURCE_HPP_
@@ -3,6 +3,7 @@
 #define INCLUDED_PATTON_NEW_HPP_
 
 
+#include <span>
 #include <cstddef> // for size_t
 
 
@@ -23,6 +24,15 @@ namespace patton {
 [[nodiscard]] std::size_t
 hardware_large_page_size() noexcept;
 
+    //
+    // Reports all large page sizes supported by the operating system in bytes, in ascending order.
+    //ᅟ
+    // On Linux, these are the page sizes available for explicit large page allocations as listed in `/sys/kernel/mm/hugepages`.
+    // On Windows, only the minimum large page size is reported. The list is empty if large pages are not supported.
+    //
+[[nodiscard]] std::span<std::size_t const>
+hardware_large_page_sizes() noexcept;
+
     //
     // Reports the operating system's page size in bytes.
     //
@@ -4,6 +4,7 @@
 
 
 #include <span>
+#include <cstddef>  // for size_t
 
 
 namespace patton {
@@ -30,6 +31,42 @@ physical_concurrency() noexcept;
 physical_core_ids() noexcept;
 
 
+    //
+    // Reports the number of NUMA nodes.
+    //ᅟ
+    // NUMA nodes are identified by dense indices in the range [0, `numa_node_count()`), which need not coincide with the node ids
+    // used by the OS. If NUMA topology information is not available, the system is reported as a single NUMA node comprising all
+    // hardware threads.
+    //
+[[nodiscard]] int
+numa_node_count() noexcept;
+
+    //
+    // Returns the sorted list of ids of the hardware threads which belong to the given NUMA node.
+    //
+[[nodiscard]] std::span<int const>
+numa_node_hardware_thread_ids(int node) noexcept;
+
+    //
+    // Returns the index of the NUMA node the given hardware thread belongs to, or -1 if the hardware thread is unknown.
+    //
+[[nodiscard]] int
+numa_node_of_hardware_thread(int hardwareThreadId) noexcept;
+
+    //
+    // Returns the relative distance between the given NUMA nodes as reported by the firmware (cf. the ACPI SLIT table). The
+    // distance of a node to itself is conventionally 10.
+    //
+[[nodiscard]] int
+numa_node_distance(int node1, int node2) noexcept;
+
+    //
+    // Returns the size of the memory attached to the given NUMA node in bytes, or 0 if the size is unknown.
+    //
+[[nodiscard]] std::size_t
+numa_node_memory_size(int node) noexcept;
+
+
 } // namespace patton
 
 
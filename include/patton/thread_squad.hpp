@@ -4,12 +4,19 @@
 
 
 #include <span>
-#include <utility>     // for move()
+#include <chrono>
+#include <memory>      // for unique_ptr<>
+#include <cstddef>     // for ptrdiff_t
+#include <cstdint>     // for uint32_t
+#include <utility>     // for move(), exchange()
+#include <algorithm>   // for min()
 #include <concepts>
 #include <functional>  // for function<>, identity
 
 #include <gsl-lite/gsl-lite.hpp>  // for not_null<>
 
+#include <patton/memory.hpp>  // for arena
+
 #include <patton/detail/thread_squad.hpp>
 
 
@@ -25,6 +32,84 @@ namespace gsl = ::gsl_lite;
 class thread_squad
 {
 public:
+        //
+        // Policies for placing the threads of a thread squad on hardware threads.
+        //
+    enum class placement_policy
+    {
+            //
+            // Threads are pinned to hardware threads as specified by `hardware_thread_mappings`.
+            //
+        none,
+
+            //
+            // Threads are placed on as few NUMA nodes and cores as possible, filling all hardware threads of one node before
+            // using the next node.
+            //
+        compact,
+
+            //
+            // Threads are distributed evenly across all NUMA nodes. Within a node, threads are placed on distinct cores before
+            // hardware threads of the same core are used.
+            //
+        scatter,
+
+            //
+            // Threads are placed on distinct cores before hardware threads of the same core are used. Cores are used in the
+            // order of their NUMA nodes.
+            //
+        cores_first
+    };
+
+        //
+        // Policies for waiting on other threads of a thread squad.
+        //
+    enum class wait_policy
+    {
+            //
+            // Threads block right away when waiting. Blocked threads are woken by the operating system, which can take tens of
+            // microseconds.
+            //
+        block,
+
+            //
+            // Threads spin with exponential backoff for a fixed duration before blocking.
+            //
+        spin,
+
+            //
+            // Threads waiting for a new task spin for a duration which is adapted to the wait durations observed by the thread:
+            // threads which are usually woken after a short wait spin long enough to avoid blocking, and threads which are
+            // usually idle for long spin only briefly before blocking. Waits within a task use spin waiting as with
+            // `wait_policy::spin`.
+            //
+        adaptive_spin
+    };
+
+        //
+        // Shapes of the synchronization tree along which the threads of a thread squad are woken, synchronized, and joined.
+        //
+    enum class tree_topology
+    {
+            //
+            // Every thread has at most `tree_breadth` direct subordinates.
+            //
+        uniform,
+
+            //
+            // Thread 0 is the direct superior of all other threads. Can be cheaper than a deeper tree for small thread squads.
+            //
+        flat,
+
+            //
+            // The levels of the tree follow the hardware topology: the first level splits the threads by package ("socket"),
+            // the next by last-level cache domain, and the last by core. Levels with more than `tree_breadth` subtrees are
+            // subdivided further as in the uniform tree. Falls back to `tree_topology::uniform` if threads are not pinned to
+            // hardware threads.
+            //
+        hardware
+    };
+
         //
         // Thread squad parameters.
         //
@@ -42,7 +127,8 @@ public:
         bool pin_to_hardware_threads = false;
 
             //
-            // Controls whether thread synchronization uses spin waiting with exponential backoff.
+            // Controls whether thread synchronization uses spin waiting with exponential backoff. Setting `spin_wait` to `true`
+            // is equivalent to setting `wait` to `wait_policy::spin`.
             //
         bool spin_wait = false;
 
@@ -65,6 +151,106 @@ public:
             // number of hardware threads to pin threads to.
             //
         std::span<int const> hardware_thread_mappings = { };
+
+            //
+            // Policy for placing threads on hardware threads. Only has an effect if `pin_to_hardware_threads` is `true`.
+            //ᅟ
+            // For policies other than `placement_policy::none`, the mapping of thread indices to hardware threads is computed
+            // from the detected topology (cf. `numa_node_count()`), and `hardware_thread_mappings` must be empty. Threads on the
+            // same NUMA node have consecutive thread indices, so subtrees of the thread squad's synchronization tree tend to
+            // coincide with NUMA nodes, and synchronization across nodes happens only at the top of the tree.
+            //
+        placement_policy placement = placement_policy::none;
+
+            //
+            // Size in bytes of the per-thread arena made available to tasks through `task_context::arena()`. A value of 0
+            // indicates that tasks get an empty arena which forwards all allocations to global `operator new()`.
+            //ᅟ
+            // Arena memory is obtained with page granularity and faulted in by the thread which uses it.
+            //
+        std::size_t arena_size = 0;
+
+            //
+            // Policy for waiting on other threads. If `spin_wait` is `true`, `wait` must be `wait_policy::block` or
+            // `wait_policy::spin`.
+            //
+        wait_policy wait = wait_policy::block;
+
+            //
+            // Controls whether threads waiting for a new task are woken with a single broadcast notification rather than
+            // along the thread squad's synchronization tree, where every thread wakes its subordinate threads. If all threads
+            // are blocked, the controlling thread first wakes thread 0, which then wakes all other threads at once, so starting
+            // a task takes two consecutive wake-ups rather than one per tree level. All blocked threads are woken even if a task
+            // is run with lower concurrency.
+            //ᅟ
+            // Requires `wait_policy::block`; `spin_wait` must be `false`.
+            //
+        bool broadcast_wake = false;
+
+            //
+            // Shape of the synchronization tree.
+            //ᅟ
+            // With `tree_topology::hardware`, levels of the tree coincide with hardware boundaries only if threads on the same
+            // package, cache domain, and core have consecutive thread indices, as is the case for placement policies other than
+            // `placement_policy::none`.
+            //
+        tree_topology topology = tree_topology::uniform;
+
+            //
+            // Maximal number of direct subordinates of a thread in the synchronization tree. Must be at least 2. Has no effect
+            // for `tree_topology::flat`.
+            //
+        int tree_breadth = 8;
+    };
+
+        //
+        // Strategies for partitioning an index range among the threads of a thread squad.
+        //
+    enum class schedule_kind
+    {
+            //
+            // Every thread processes one contiguous block of indices. Block sizes differ by at most one index.
+            //
+        static_block,
+
+            //
+            // Chunks of `chunk_size` indices are assigned to the threads in a round-robin fashion.
+            //
+        static_cyclic,
+
+            //
+            // Threads dynamically claim chunks of `chunk_size` indices until the index range is exhausted.
+            //
+        chunked,
+
+            //
+            // Threads dynamically claim chunks of decreasing size. The size of a chunk is proportional to the number of remaining
+            // indices divided by the number of threads, but no smaller than `chunk_size`.
+            //
+        guided,
+
+            //
+            // Every thread initially owns a contiguous block of chunks of `chunk_size` indices. Threads which have run out of
+            // chunks steal chunks from other threads, preferring threads which are close in the thread squad's tree.
+            //
+        work_stealing
+    };
+
+        //
+        // Loop schedule for `for_each_index()`.
+        //
+    struct schedule
+    {
+            //
+            // The strategy by which the index range is partitioned.
+            //
+        schedule_kind kind = schedule_kind::static_block;
+
+            //
+            // The (minimal) number of consecutive indices processed by a thread at once. Ignored for `schedule_kind::static_block`.
+            // A value of 0 indicates a chunk size of 1.
+            //
+        std::ptrdiff_t chunk_size = 0;
     };
 
         //
@@ -72,8 +258,12 @@ public:
         //
     class task_context
     {
+        friend thread_squad;
         friend detail::task_context_factory;
 
+    public:
+        class arrival_token;
+
     private:
         detail::thread_squad_impl_base& impl_;
         int threadIdx_;
@@ -88,8 +278,42 @@ public:
         collect(detail::task_context_synchronizer& synchronizer) noexcept;
         void
         broadcast(detail::task_context_synchronizer& synchronizer) noexcept;
+        [[nodiscard]] bool
+        next_chunk(std::uint32_t& chunk) noexcept;
 
     public:
+            //
+            // Token returned by `arrive()` which must be passed to `wait()`.
+            //
+        class [[nodiscard]] arrival_token
+        {
+            friend task_context;
+
+        private:
+            int numCollected_;
+            bool arrived_;
+            bool valid_;
+
+            arrival_token(int _numCollected, bool _arrived) noexcept
+                : numCollected_(_numCollected), arrived_(_arrived), valid_(true)
+            {
+            }
+
+        public:
+            arrival_token(arrival_token&& rhs) noexcept
+                : numCollected_(rhs.numCollected_), arrived_(rhs.arrived_), valid_(std::exchange(rhs.valid_, false))
+            {
+            }
+            arrival_token&
+            operator =(arrival_token&& rhs) noexcept
+            {
+                numCollected_ = rhs.numCollected_;
+                arrived_ = rhs.arrived_;
+                valid_ = std::exchange(rhs.valid_, false);
+                return *this;
+            }
+        };
+
             //
             // The current thread index.
             //
@@ -108,6 +332,15 @@ public:
             return numRunningThreads_;
         }
 
+            //
+            // The arena of the current thread, which can be used for short-lived allocations with `arena_allocator<>`.
+            //ᅟ
+            // The arena is reset after the current thread has finished executing the task, so allocations must not outlive
+            // the task. Its size is controlled by `params::arena_size`.
+            //
+        [[nodiscard]] patton::arena&
+        arena() const noexcept;
+
             //
             // Synchronizes all threads which execute the current task.
             //ᅟ
@@ -122,6 +355,26 @@ public:
             broadcast(synchronizer);
         }
 
+            //
+            // Signals that the calling thread has arrived at the synchronization point without waiting for the other threads.
+            // The returned token must be passed to `wait()`, which completes the synchronization.
+            //ᅟ
+            // `arrive()` and `wait()` together synchronize like `synchronize()`: all memory writes made by any participating thread
+            // before its call to `arrive()` are visible to all participating threads after their call to `wait()` returns. The
+            // calling thread may do other work in between, but it must not execute other synchronization operations.
+            // It is the responsibility of the task to ensure that synchronization operations such as `arrive()`, `synchronize()`,
+            // `reduce_transform()`, and `reduce()` are executed by all participating threads unconditionally and in the same order.
+            //
+        [[nodiscard]] arrival_token
+        arrive() noexcept;
+
+            //
+            // Waits until all threads which execute the current task have arrived at the synchronization point started with
+            // `arrive()`.
+            //
+        void
+        wait(arrival_token&& token) noexcept;
+
             //
             // Synchronizes all threads which execute the current task and computes the reduction of `value` for all threads
             // with the reduction operation `reduceOp`. The result of the reduction is transformed with the `transformFunc` operation,
@@ -170,6 +423,73 @@ public:
         }
     };
 
+        //
+        // Handle to a task started with `run_async()`.
+        //ᅟ
+        // The handle must not outlive the thread squad. If the task has not been awaited when the handle is destroyed, the
+        // destructor waits for the task to complete.
+        //
+    class completion_handle
+    {
+        friend thread_squad;
+
+    private:
+        detail::thread_squad_impl_base* impl_;
+        std::uint64_t sequenceNumber_;
+
+        completion_handle(detail::thread_squad_impl_base* _impl, std::uint64_t _sequenceNumber) noexcept
+            : impl_(_impl), sequenceNumber_(_sequenceNumber)
+        {
+        }
+
+        [[nodiscard]] bool
+        do_wait_for(std::chrono::nanoseconds timeout) noexcept;
+
+    public:
+        completion_handle(completion_handle&& rhs) noexcept
+            : impl_(std::exchange(rhs.impl_, nullptr)), sequenceNumber_(rhs.sequenceNumber_)
+        {
+        }
+        completion_handle&
+        operator =(completion_handle&& rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                wait();
+                impl_ = std::exchange(rhs.impl_, nullptr);
+                sequenceNumber_ = rhs.sequenceNumber_;
+            }
+            return *this;
+        }
+        ~completion_handle()
+        {
+            wait();
+        }
+
+            //
+            // Waits until the task has run to completion.
+            //
+        void
+        wait() noexcept;
+
+            //
+            // Returns `true` if the task has run to completion, and `false` otherwise. Does not block.
+            //
+        [[nodiscard]] bool
+        try_wait() noexcept;
+
+            //
+            // Waits until the task has run to completion or until the given timeout has passed. Returns `true` if the task
+            // has run to completion, and `false` otherwise.
+            //
+        template <typename Rep, typename Period>
+        [[nodiscard]] bool
+        wait_for(std::chrono::duration<Rep, Period> const& timeout) noexcept
+        {
+            return do_wait_for(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+        }
+    };
+
 private:
     gsl::not_null<detail::thread_squad_handle> handle_;
 
@@ -181,6 +501,10 @@ private:
         gsl_Expects(p.num_threads == 0 || p.max_num_hardware_threads <= p.num_threads);
         gsl_Expects(p.hardware_thread_mappings.empty() || (p.max_num_hardware_threads <= std::ssize(p.hardware_thread_mappings)
             && p.num_threads <= std::ssize(p.hardware_thread_mappings)));
+        gsl_Expects(p.placement == placement_policy::none || p.hardware_thread_mappings.empty());
+        gsl_Expects(!p.spin_wait || p.wait == wait_policy::block || p.wait == wait_policy::spin);
+        gsl_Expects(!p.broadcast_wake || (!p.spin_wait && p.wait == wait_policy::block));
+        gsl_Expects(p.tree_breadth >= 2);
         return p;
     }
 
@@ -189,6 +513,77 @@ private:
 
     void
     do_run(detail::thread_squad_task& op);
+    std::uint64_t
+    do_run_async(detail::thread_squad_task* op, detail::thread_squad_task_deleter deleter) noexcept;
+    void
+    assign_chunks(std::uint32_t numChunks, int concurrency) noexcept;
+
+    static std::ptrdiff_t
+    loop_chunk_size(std::ptrdiff_t first, std::ptrdiff_t last, schedule sched) noexcept
+    {
+        std::ptrdiff_t chunkSize = sched.chunk_size != 0 ? sched.chunk_size : 1;
+        if (sched.kind == schedule_kind::work_stealing)
+        {
+                // Chunk indices are stored as 32-bit integers.
+            constexpr std::ptrdiff_t maxNumChunks = std::ptrdiff_t(std::uint32_t(-1));
+            chunkSize = std::max(chunkSize, (last - first + (maxNumChunks - 1))/maxNumChunks);
+        }
+        return chunkSize;
+    }
+
+    template <typename BodyT>
+    auto
+    make_for_each_index_action(std::ptrdiff_t first, std::ptrdiff_t last, BodyT&& body, schedule sched, int concurrency, detail::loop_counter& counter)
+    {
+        counter.next.store(first, std::memory_order_relaxed);
+        std::ptrdiff_t chunkSize = loop_chunk_size(first, last, sched);
+        if (sched.kind == schedule_kind::work_stealing && concurrency != 0)
+        {
+            assign_chunks(static_cast<std::uint32_t>((last - first + (chunkSize - 1))/chunkSize), concurrency);
+        }
+        return [first, last, body = std::move(body), kind = sched.kind, chunkSize, &counter]
+        (task_context& ctx) mutable
+        {
+            switch (kind)
+            {
+            case schedule_kind::static_block:
+                detail::for_each_index_static_block(body, first, last, ctx.thread_index(), ctx.num_threads());
+                break;
+            case schedule_kind::static_cyclic:
+                detail::for_each_index_static_cyclic(body, first, last, chunkSize, ctx.thread_index(), ctx.num_threads());
+                break;
+            case schedule_kind::chunked:
+                detail::for_each_index_chunked(body, last, chunkSize, counter);
+                break;
+            case schedule_kind::guided:
+                detail::for_each_index_guided(body, last, chunkSize, ctx.num_threads(), counter);
+                break;
+            case schedule_kind::work_stealing:
+                {
+                    std::uint32_t chunk;
+                    while (ctx.next_chunk(chunk))
+                    {
+                        std::ptrdiff_t chunkFirst = first + chunk*chunkSize;
+                        std::ptrdiff_t chunkLast = chunkFirst + std::min(chunkSize, last - chunkFirst);
+                        for (std::ptrdiff_t j = chunkFirst; j != chunkLast; ++j)
+                        {
+                            body(j);
+                        }
+                    }
+                }
+                break;
+            }
+        };
+    }
+
+    static int
+    loop_concurrency(std::ptrdiff_t first, std::ptrdiff_t last, schedule sched, int concurrency) noexcept
+    {
+            // There is no point in waking threads for which there is no work.
+        std::ptrdiff_t chunkSize = sched.kind == schedule_kind::static_block ? 1 : loop_chunk_size(first, last, sched);
+        std::ptrdiff_t numChunks = (last - first + (chunkSize - 1))/chunkSize;
+        return static_cast<int>(std::min<std::ptrdiff_t>(concurrency, numChunks));
+    }
 
 public:
     explicit thread_squad(params const& p)
@@ -237,6 +632,36 @@ public:
         do_run(op);
     }
 
+        //
+        // Runs the given action on `concurrency` threads and returns without waiting for the tasks to complete. The returned
+        // handle can be used to wait for the completion of the tasks.
+        //ᅟ
+        // `concurrency` must not exceed the number of threads in the thread squad. A value of -1 indicates that all available
+        // threads shall be used.
+        // The thread squad makes a dedicated copy of `action` for every participating thread and invokes it with a thread-specific
+        // `task_context&` argument. If `action` throws an exception, `std::terminate()` is called.
+        // Actions submitted with `run_async()` are executed in submission order. Up to 8 actions can be pending; if more are
+        // submitted, `run_async()` blocks until a pending action has run to completion. Any other operation on the thread squad
+        // first waits for the completion of all pending actions.
+        //
+    template <std::invocable<task_context&> ActionT>
+    requires std::copy_constructible<ActionT>
+    [[nodiscard]] completion_handle
+    run_async(ActionT action, int concurrency = -1) &
+    {
+        gsl_Expects(concurrency >= -1 && concurrency <= handle_->numThreads);
+
+        if (concurrency == -1)
+        {
+            concurrency = handle_->numThreads;
+        }
+        using Op = detail::thread_squad_action<task_context, ActionT>;
+        auto op = std::make_unique<Op>(std::move(action));
+        op->params.concurrency = concurrency;
+        std::uint64_t sequenceNumber = do_run_async(op.release(), &detail::delete_task<Op>);
+        return completion_handle(handle_.get(), sequenceNumber);
+    }
+
         //
         // Runs the given action on `concurrency` threads and waits until all tasks have run to completion.
         //ᅟ
@@ -262,6 +687,63 @@ public:
         do_run(op);
     }
 
+        //
+        // Invokes `body(i)` for every index `i` in the range [`first`, `last`) on `concurrency` threads and waits until all
+        // invocations have run to completion.
+        //ᅟ
+        // The index range is partitioned among the threads as specified by `sched`.
+        // `concurrency` must not exceed the number of threads in the thread squad. A value of -1 indicates that all available
+        // threads shall be used.
+        // The thread squad makes a dedicated copy of `body` for every participating thread. If `body` throws an exception,
+        // `std::terminate()` is called.
+        //
+    template <std::invocable<std::ptrdiff_t> BodyT>
+    requires std::copy_constructible<BodyT>
+    void
+    for_each_index(std::ptrdiff_t first, std::ptrdiff_t last, BodyT body, schedule sched = { }, int concurrency = -1) &
+    {
+        gsl_Expects(first <= last);
+        gsl_Expects(sched.chunk_size >= 0);
+        gsl_Expects(concurrency >= -1 && concurrency <= handle_->numThreads);
+
+        if (concurrency == -1)
+        {
+            concurrency = handle_->numThreads;
+        }
+        concurrency = loop_concurrency(first, last, sched, concurrency);
+        auto counter = detail::loop_counter{ };
+        run(make_for_each_index_action(first, last, std::move(body), sched, concurrency, counter), concurrency);
+    }
+
+        //
+        // Invokes `body(i)` for every index `i` in the range [`first`, `last`) on `concurrency` threads and waits until all
+        // invocations have run to completion.
+        //ᅟ
+        // The index range is partitioned among the threads as specified by `sched`.
+        // `concurrency` must not exceed the number of threads in the thread squad. A value of -1 indicates that all available
+        // threads shall be used.
+        // The thread squad makes a dedicated copy of `body` for every participating thread. If `body` throws an exception,
+        // `std::terminate()` is called.
+        //
+    template <std::invocable<std::ptrdiff_t> BodyT>
+    requires std::copy_constructible<BodyT>
+    void
+    for_each_index(std::ptrdiff_t first, std::ptrdiff_t last, BodyT body, schedule sched = { }, int concurrency = -1) &&
+    {
+        gsl_Expects(first <= last);
+        gsl_Expects(sched.chunk_size >= 0);
+        gsl_Expects(concurrency >= -1 && concurrency <= handle_->numThreads);
+
+        if (concurrency == -1)
+        {
+            concurrency = handle_->numThreads;
+        }
+        concurrency = loop_concurrency(first, last, sched, concurrency);
+        auto counter = detail::loop_counter{ };
+        auto action = make_for_each_index_action(first, last, std::move(body), sched, concurrency, counter);
+        std::move(*this).run(std::move(action), concurrency);
+    }
+
         //
         // Runs `transformFunc` on `concurrency` threads and waits until all tasks have run to completion, then reduces
         // the results using the `reduceOp` operator.
@@ -0,0 +1,198 @@
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for int32_t, int64_t
+#include <algorithm>  // for fill()
+
+#include <patton/algorithm.hpp>
+
+#include <patton/detail/algorithm.hpp>
+
+
+    // On x86 with GCC or Clang, kernels are additionally compiled for AVX2 and selected at runtime. Other compilers and
+    // architectures use the kernels compiled for the baseline instruction set, which are still vectorized.
+#if (defined(__i386__) || defined(__x86_64__)) && (defined(__GNUC__) || defined(__clang__))
+# define PATTON_DISPATCH_AVX2
+# define PATTON_FORCE_INLINE [[gnu::always_inline]] inline
+#else
+# define PATTON_FORCE_INLINE inline
+#endif
+
+    // The loop over the accumulators must be unrolled so that the accumulators are held in registers.
+#if defined(__GNUC__) || defined(__clang__)
+# define PATTON_UNROLL _Pragma("GCC unroll 32")
+#else
+# define PATTON_UNROLL
+#endif
+
+
+namespace patton::detail {
+
+
+namespace {
+
+
+    // Number of independent accumulators. Four 256-bit registers' worth of accumulators hide the latency of vector
+    // operations, and because every accumulator is updated in program order, the compiler can vectorize the loops without
+    // reassociating floating-point operations.
+template <typename T>
+constexpr std::size_t numAccumulators = 4*32/sizeof(T);
+
+template <typename T, typename ReductionT>
+PATTON_FORCE_INLINE T
+reduce_kernel(ReductionT reduction, T const* data, std::size_t n) noexcept
+{
+    constexpr std::size_t k = numAccumulators<T>;
+
+    T acc[k];
+    std::fill(acc, acc + k, reduction.template identity<T>());
+    std::size_t i = 0;
+    for (; n - i >= k; i += k)
+    {
+        PATTON_UNROLL
+        for (std::size_t j = 0; j != k; ++j)
+        {
+            acc[j] = reduction(acc[j], data[i + j]);
+        }
+    }
+    T result = reduction.template identity<T>();
+    for (; i != n; ++i)
+    {
+        result = reduction(result, data[i]);
+    }
+    for (std::size_t j = 0; j != k; ++j)
+    {
+        result = reduction(result, acc[j]);
+    }
+    return result;
+}
+
+template <typename T>
+PATTON_FORCE_INLINE T
+dot_kernel(T const* x, T const* y, std::size_t n) noexcept
+{
+    constexpr std::size_t k = numAccumulators<T>;
+
+    T acc[k] = { };
+    std::size_t i = 0;
+    for (; n - i >= k; i += k)
+    {
+        PATTON_UNROLL
+        for (std::size_t j = 0; j != k; ++j)
+        {
+            acc[j] = detail::wrapping_add(acc[j], detail::wrapping_multiply(x[i + j], y[i + j]));
+        }
+    }
+    T result = { };
+    for (; i != n; ++i)
+    {
+        result = detail::wrapping_add(result, detail::wrapping_multiply(x[i], y[i]));
+    }
+    for (std::size_t j = 0; j != k; ++j)
+    {
+        result = detail::wrapping_add(result, acc[j]);
+    }
+    return result;
+}
+
+template <typename T, typename ReductionT>
+T
+reduce_baseline(ReductionT reduction, T const* data, std::size_t n) noexcept
+{
+    return detail::reduce_kernel(reduction, data, n);
+}
+template <typename T>
+T
+dot_baseline(T const* x, T const* y, std::size_t n) noexcept
+{
+    return detail::dot_kernel(x, y, n);
+}
+
+#if defined(PATTON_DISPATCH_AVX2)
+template <typename T, typename ReductionT>
+[[gnu::target("avx2"), gnu::flatten]] T
+reduce_avx2(ReductionT reduction, T const* data, std::size_t n) noexcept
+{
+    return detail::reduce_kernel(reduction, data, n);
+}
+template <typename T>
+[[gnu::target("avx2"), gnu::flatten]] T
+dot_avx2(T const* x, T const* y, std::size_t n) noexcept
+{
+    return detail::dot_kernel(x, y, n);
+}
+
+bool
+cpu_supports_avx2() noexcept
+{
+    static bool const result = __builtin_cpu_supports("avx2");
+    return result;
+}
+#endif // defined(PATTON_DISPATCH_AVX2)
+
+template <typename T, typename ReductionT>
+T
+dispatch_reduce(ReductionT reduction, T const* data, std::size_t n) noexcept
+{
+#if defined(PATTON_DISPATCH_AVX2)
+    if (detail::cpu_supports_avx2())
+    {
+        return detail::reduce_avx2(reduction, data, n);
+    }
+#endif // defined(PATTON_DISPATCH_AVX2)
+    return detail::reduce_baseline(reduction, data, n);
+}
+
+
+} // anonymous namespace
+
+
+template <simd_arithmetic T>
+T
+simd_sum(T const* data, std::size_t n) noexcept
+{
+    return detail::dispatch_reduce(sum_reduction{ }, data, n);
+}
+template <simd_arithmetic T>
+T
+simd_min(T const* data, std::size_t n) noexcept
+{
+    return detail::dispatch_reduce(min_reduction{ }, data, n);
+}
+template <simd_arithmetic T>
+T
+simd_max(T const* data, std::size_t n) noexcept
+{
+    return detail::dispatch_reduce(max_reduction{ }, data, n);
+}
+template <simd_arithmetic T>
+T
+simd_dot(T const* x, T const* y, std::size_t n) noexcept
+{
+#if defined(PATTON_DISPATCH_AVX2)
+    if (detail::cpu_supports_avx2())
+    {
+        return detail::dot_avx2(x, y, n);
+    }
+#endif // defined(PATTON_DISPATCH_AVX2)
+    return detail::dot_baseline(x, y, n);
+}
+
+template float simd_sum<float>(float const*, std::size_t) noexcept;
+template double simd_sum<double>(double const*, std::size_t) noexcept;
+template std::int32_t simd_sum<std::int32_t>(std::int32_t const*, std::size_t) noexcept;
+template std::int64_t simd_sum<std::int64_t>(std::int64_t const*, std::size_t) noexcept;
+template float simd_min<float>(float const*, std::size_t) noexcept;
+template double simd_min<double>(double const*, std::size_t) noexcept;
+template std::int32_t simd_min<std::int32_t>(std::int32_t const*, std::size_t) noexcept;
+template std::int64_t simd_min<std::int64_t>(std::int64_t const*, std::size_t) noexcept;
+template float simd_max<float>(float const*, std::size_t) noexcept;
+template double simd_max<double>(double const*, std::size_t) noexcept;
+template std::int32_t simd_max<std::int32_t>(std::int32_t const*, std::size_t) noexcept;
+template std::int64_t simd_max<std::int64_t>(std::int64_t const*, std::size_t) noexcept;
+template float simd_dot<float>(float const*, float const*, std::size_t) noexcept;
+template double simd_dot<double>(double const*, double const*, std::size_t) noexcept;
+template std::int32_t simd_dot<std::int32_t>(std::int32_t const*, std::int32_t const*, std::size_t) noexcept;
+template std::int64_t simd_dot<std::int64_t>(std::int64_t const*, std::int64_t const*, std::size_t) noexcept;
+
+
+} // namespace patton::detail
@@ -1,14 +1,17 @@
 ﻿
 #include <span>
+#include <mutex>      // for once_flag, call_once()
 #include <atomic>
 #include <memory>     // for unique_ptr<>
 #include <string>
+#include <thread>     // for thread::hardware_concurrency()
 #include <vector>
-#include <cstddef>    // for ptrdiff_t
+#include <cstddef>    // for size_t, ptrdiff_t
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <stdexcept>  // for runtime_error
-#include <algorithm>  // for sort(), unique()
+#include <algorithm>  // for sort(), unique(), fill(), any_of(), min_element()
 
 #if defined(_WIN32)
 # ifndef NOMINMAX
@@ -30,6 +33,7 @@
 #include <gsl-lite/gsl-lite.hpp>  // for dim, gsl_ExpectsAudit(), narrow_failfast<>()
 
 #include <patton/detail/errors.hpp>
+#include <patton/detail/cpuinfo.hpp>
 
 
 namespace patton {
@@ -41,6 +45,17 @@ namespace gsl = ::gsl_lite;
 namespace patton::detail {
 
 
+struct numa_info
+{
+    int node_count = 0;
+    std::vector<int> node_os_ids;                         // OS node id of every node
+    std::vector<std::vector<int>> node_hardware_thread_ids;  // sorted list of hardware thread ids of every node
+    std::vector<int> hardware_thread_nodes;               // node of every hardware thread id, or -1 if unknown
+    std::vector<int> node_distances;                      // `node_count × node_count` matrix of relative node distances
+    std::vector<std::size_t> node_memory_sizes;           // size of the memory of every node in bytes, or 0 if unknown
+    std::vector<hardware_thread_info> hardware_threads;   // topology of every known hardware thread, ordered by id
+};
+
 struct cpu_info
 {
 #if defined(_WIN32)
@@ -52,6 +67,12 @@ struct cpu_info
     std::atomic<int const*> core_thread_ids_ptr;
     std::vector<int> core_thread_ids;
 #endif // defined(_WIN32) || defined(__linux__)
+
+    std::once_flag numa_init_flag;
+    numa_info numa;
+
+    std::once_flag cache_init_flag;
+    std::vector<cache_info> data_caches;
 };
 
 
@@ -243,6 +264,330 @@ init_cpu_info() noexcept
 }
 
 
+#if defined(__linux__)
+    // Parses a CPU or node list such as "0-3,8-11" as found in sysfs.
+static std::vector<int>
+parse_id_list(std::string const& str)
+{
+    auto result = std::vector<int>{ };
+    auto is = std::istringstream(str);
+    auto range = std::string{ };
+    while (std::getline(is, range, ','))
+    {
+        int first, last;
+        int nFields = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (nFields == 1)
+        {
+            last = first;
+        }
+        else if (nFields != 2 || first < 0 || last < first)
+        {
+            throw std::runtime_error("error parsing id list \"" + str + "\"");
+        }
+        for (int id = first; id <= last; ++id)
+        {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
+
+static std::string
+read_line(std::string const& path)
+{
+    auto f = std::ifstream(path);
+    if (!f) throw std::runtime_error("cannot open " + path);
+    auto line = std::string{ };
+    std::getline(f, line);
+    return line;
+}
+
+static void
+read_numa_info_from_sysfs(numa_info& numa)
+{
+    auto const nodePath = std::string("/sys/devices/system/node/");
+    numa.node_os_ids = detail::parse_id_list(detail::read_line(nodePath + "online"));
+    numa.node_count = gsl::narrow_failfast<int>(numa.node_os_ids.size());
+    if (numa.node_count == 0) throw std::runtime_error("no NUMA nodes listed in " + nodePath + "online");
+
+    numa.node_hardware_thread_ids.resize(numa.node_os_ids.size());
+    numa.node_distances.resize(numa.node_os_ids.size()*numa.node_os_ids.size());
+    numa.node_memory_sizes.resize(numa.node_os_ids.size());
+    for (int i = 0; i < numa.node_count; ++i)
+    {
+        auto path = nodePath + "node" + std::to_string(numa.node_os_ids[i]) + "/";
+
+        auto& hardwareThreadIds = numa.node_hardware_thread_ids[i];
+        hardwareThreadIds = detail::parse_id_list(detail::read_line(path + "cpulist"));
+        std::sort(hardwareThreadIds.begin(), hardwareThreadIds.end());
+        for (int id : hardwareThreadIds)
+        {
+            if (std::ssize(numa.hardware_thread_nodes) <= id)
+            {
+                numa.hardware_thread_nodes.resize(gsl::narrow_failfast<std::size_t>(id) + 1, -1);
+            }
+            numa.hardware_thread_nodes[id] = i;
+        }
+
+            // The distance file lists the distances to all online nodes in ascending order of their ids.
+        auto distances = std::istringstream(detail::read_line(path + "distance"));
+        for (int j = 0; j < numa.node_count; ++j)
+        {
+            int distance;
+            if (!(distances >> distance)) throw std::runtime_error("error parsing " + path + "distance");
+            numa.node_distances[i*numa.node_count + j] = distance;
+        }
+
+        auto meminfo = std::ifstream(path + "meminfo");
+        auto line = std::string{ };
+        while (std::getline(meminfo, line))
+        {
+            int osId;
+            unsigned long long sizeInKiB;
+            if (std::sscanf(line.c_str(), "Node %d MemTotal: %llu kB", &osId, &sizeInKiB) == 2)
+            {
+                numa.node_memory_sizes[i] = gsl::narrow_failfast<std::size_t>(sizeInKiB*1024);
+                break;
+            }
+        }
+    }
+}
+#endif // defined(__linux__)
+
+static int
+read_hardware_thread_topology_value([[maybe_unused]] int id, [[maybe_unused]] char const* name, int defaultValue)
+{
+#if defined(__linux__)
+    try
+    {
+        auto path = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/" + name;
+        return std::stoi(detail::read_line(path));
+    }
+    catch (std::exception const&)
+    {
+    }
+#endif // defined(__linux__)
+    return defaultValue;
+}
+
+    // Returns the id of the first hardware thread which shares the last-level data or unified cache with the given hardware
+    // thread, or -1 if it cannot be determined.
+static int
+read_hardware_thread_llc([[maybe_unused]] int id)
+{
+#if defined(__linux__)
+    auto const cachePath = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/cache/";
+    int maxLevel = 0;
+    int result = -1;
+    for (int index = 0; ; ++index)
+    {
+        auto path = cachePath + "index" + std::to_string(index) + "/";
+        try
+        {
+            auto type = detail::read_line(path + "type");
+            if (type != "Data" && type != "Unified") continue;
+            int level = std::stoi(detail::read_line(path + "level"));
+            if (level <= maxLevel) continue;
+            auto sharedIds = detail::parse_id_list(detail::read_line(path + "shared_cpu_list"));
+            if (sharedIds.empty()) continue;
+            maxLevel = level;
+            result = *std::min_element(sharedIds.begin(), sharedIds.end());
+        }
+        catch (std::exception const&)
+        {
+            break;  // no more caches
+        }
+    }
+    return result;
+#else // !defined(__linux__)
+    return -1;
+#endif // defined(__linux__)
+}
+
+static void
+init_hardware_thread_infos(numa_info& numa)
+{
+    for (int id = 0; id < std::ssize(numa.hardware_thread_nodes); ++id)
+    {
+        if (numa.hardware_thread_nodes[id] >= 0)
+        {
+                // If the topology of the hardware thread is unknown, treat it as a core of its own.
+            numa.hardware_threads.push_back(hardware_thread_info{
+                .id = id,
+                .node = numa.hardware_thread_nodes[id],
+                .package = detail::read_hardware_thread_topology_value(id, "physical_package_id", 0),
+                .core = detail::read_hardware_thread_topology_value(id, "core_id", id),
+                .llc = detail::read_hardware_thread_llc(id),
+                .smt_rank = 0
+            });
+        }
+    }
+    for (auto& hwThread : numa.hardware_threads)
+    {
+        for (auto const& other : numa.hardware_threads)
+        {
+            if (other.id < hwThread.id && other.package == hwThread.package && other.core == hwThread.core)
+            {
+                ++hwThread.smt_rank;
+            }
+        }
+    }
+}
+
+static void
+init_numa_info_as_single_node(numa_info& numa)
+{
+    int numHardwareThreads = std::max(1, gsl::narrow_failfast<int>(std::thread::hardware_concurrency()));
+    numa.node_count = 1;
+    numa.node_os_ids = { 0 };
+    numa.node_hardware_thread_ids.assign(1, std::vector<int>(gsl::narrow_failfast<std::size_t>(numHardwareThreads)));
+    for (int i = 0; i < numHardwareThreads; ++i)
+    {
+        numa.node_hardware_thread_ids[0][i] = i;
+    }
+    numa.hardware_thread_nodes.assign(gsl::narrow_failfast<std::size_t>(numHardwareThreads), 0);
+    numa.node_distances = { 10 };  // the conventional distance of a node to itself
+    numa.node_memory_sizes = { 0 };
+#if defined(__linux__) || defined(__APPLE__)
+    long numPages = ::sysconf(_SC_PHYS_PAGES);
+    long pageSize = ::sysconf(_SC_PAGESIZE);
+    if (numPages > 0 && pageSize > 0)
+    {
+        numa.node_memory_sizes[0] = std::size_t(numPages)*std::size_t(pageSize);
+    }
+#endif // defined(__linux__) || defined(__APPLE__)
+}
+
+numa_info const&
+get_numa_info() noexcept
+{
+    std::call_once(cpu_info_value.numa_init_flag,
+        []
+        {
+            auto numa = numa_info{ };
+#if defined(__linux__)
+            try
+            {
+                detail::read_numa_info_from_sysfs(numa);
+            }
+            catch (std::exception const&)
+            {
+                    // The sysfs node directory may be unavailable, e.g. in containers or on kernels built without NUMA support.
+                numa = numa_info{ };
+            }
+#endif // defined(__linux__)
+            if (numa.node_count == 0)
+            {
+                detail::init_numa_info_as_single_node(numa);
+            }
+            detail::init_hardware_thread_infos(numa);
+            cpu_info_value.numa = std::move(numa);
+        });
+    return cpu_info_value.numa;
+}
+
+#if defined(__linux__)
+static void
+read_data_cache_infos_from_sysfs(std::vector<cache_info>& caches)
+{
+    auto const cachePath = std::string("/sys/devices/system/cpu/cpu0/cache/");
+    for (int index = 0; ; ++index)
+    {
+        auto path = cachePath + "index" + std::to_string(index) + "/";
+        auto type = std::string{ };
+        try
+        {
+            type = detail::read_line(path + "type");
+        }
+        catch (std::exception const&)
+        {
+            break;  // no more caches
+        }
+        if (type != "Data" && type != "Unified") continue;
+        caches.push_back(cache_info{
+            .level = std::stoi(detail::read_line(path + "level")),
+            .line_size = std::stoul(detail::read_line(path + "coherency_line_size")),
+            .sets = std::stoul(detail::read_line(path + "number_of_sets")),
+            .ways = std::stoul(detail::read_line(path + "ways_of_associativity"))
+        });
+    }
+}
+#elif defined(_WIN32)
+static void
+read_data_cache_infos_from_win32(std::vector<cache_info>& caches)
+{
+    std::unique_ptr<SYSTEM_LOGICAL_PROCESSOR_INFORMATION[]> dynSlpi;
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION* pSlpi = nullptr;
+    DWORD nbSlpi = 0;
+    BOOL success = GetLogicalProcessorInformation(pSlpi, &nbSlpi);
+    if (!success && GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+    {
+        dynSlpi = std::make_unique<SYSTEM_LOGICAL_PROCESSOR_INFORMATION[]>((nbSlpi + sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) - 1) / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        pSlpi = dynSlpi.get();
+        success = GetLogicalProcessorInformation(pSlpi, &nbSlpi);
+    }
+    detail::win32_assert(success);
+    for (std::ptrdiff_t i = 0, n = nbSlpi / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION); i != n; ++i)
+    {
+        auto const& cache = pSlpi[i].Cache;
+        if (pSlpi[i].Relationship != RelationCache || (cache.Type != CacheData && cache.Type != CacheUnified)) continue;
+        if (cache.Associativity == 0 || cache.Associativity == CACHE_FULLY_ASSOCIATIVE || cache.LineSize == 0) continue;
+
+            // Every core reports its own caches, but we are interested only in one cache per level.
+        if (std::any_of(caches.begin(), caches.end(), [&cache](cache_info const& c) { return c.level == int(cache.Level); })) continue;
+        caches.push_back(cache_info{
+            .level = int(cache.Level),
+            .line_size = cache.LineSize,
+            .sets = cache.Size / (std::size_t(cache.Associativity) * cache.LineSize),
+            .ways = cache.Associativity
+        });
+    }
+}
+#endif // defined(__linux__)
+
+std::span<cache_info const>
+data_cache_infos() noexcept
+{
+    std::call_once(cpu_info_value.cache_init_flag,
+        []
+        {
+            auto caches = std::vector<cache_info>{ };
+            try
+            {
+#if defined(__linux__)
+                detail::read_data_cache_infos_from_sysfs(caches);
+#elif defined(_WIN32)
+                detail::read_data_cache_infos_from_win32(caches);
+#endif // defined(__linux__)
+            }
+            catch (std::exception const&)
+            {
+                    // The cache geometry is only used for performance heuristics, so we do not fail if it cannot be determined.
+                caches.clear();
+            }
+            std::erase_if(caches, [](cache_info const& c) { return c.line_size == 0 || c.sets == 0 || c.ways == 0; });
+            std::sort(caches.begin(), caches.end(), [](cache_info const& lhs, cache_info const& rhs) { return lhs.level < rhs.level; });
+            cpu_info_value.data_caches = std::move(caches);
+        });
+    return cpu_info_value.data_caches;
+}
+
+std::span<hardware_thread_info const>
+hardware_thread_infos() noexcept
+{
+    return detail::get_numa_info().hardware_threads;
+}
+
+int
+numa_node_os_id(int node) noexcept
+{
+    auto const& numa = detail::get_numa_info();
+    gsl_Expects(node >= 0 && node < numa.node_count);
+
+    return numa.node_os_ids[node];
+}
+
+
 } // namespace patton::detail
 
 namespace patton {
@@ -292,5 +637,50 @@ physical_core_ids() noexcept
 #endif // defined(_WIN32) || defined(__linux__)
 }
 
+int
+numa_node_count() noexcept
+{
+    return detail::get_numa_info().node_count;
+}
+
+std::span<int const>
+numa_node_hardware_thread_ids(int node) noexcept
+{
+    auto const& numa = detail::get_numa_info();
+    gsl_Expects(node >= 0 && node < numa.node_count);
+
+    return numa.node_hardware_thread_ids[node];
+}
+
+int
+numa_node_of_hardware_thread(int hardwareThreadId) noexcept
+{
+    gsl_Expects(hardwareThreadId >= 0);
+
+    auto const& numa = detail::get_numa_info();
+    return hardwareThreadId < std::ssize(numa.hardware_thread_nodes)
+        ? numa.hardware_thread_nodes[hardwareThreadId]
+        : -1;
+}
+
+int
+numa_node_distance(int node1, int node2) noexcept
+{
+    auto const& numa = detail::get_numa_info();
+    gsl_Expects(node1 >= 0 && node1 < numa.node_count);
+    gsl_Expects(node2 >= 0 && node2 < numa.node_count);
+
+    return numa.node_distances[node1*numa.node_count + node2];
+}
+
+std::size_t
+numa_node_memory_size(int node) noexcept
+{
+    auto const& numa = detail::get_numa_info();
+    gsl_Expects(node >= 0 && node < numa.node_count);
+
+    return numa.node_memory_sizes[node];
+}
+
 
 } // namespace patton
@@ -1,24 +1,42 @@
 
 #include <new>          // for operator new, bad_alloc
+#include <atomic>       // for atomic_ref<>
 #include <cerrno>
+#include <string>
+#include <mutex>
+#include <memory>       // for unique_ptr<>
+#include <vector>
+#include <utility>      // for exchange()
+#include <cstdio>       // for sscanf()
+#include <cstring>      // for strcmp(), memcpy()
+#include <fstream>
+#include <stdexcept>    // for runtime_error
+#include <climits>      // for CHAR_BIT
+#include <cstdint>      // for uintptr_t
 #include <cstddef>      // for size_t, align_val_t
-#include <algorithm>    // for min(), max()
+#include <algorithm>    // for min(), max(), clamp(), find()
 #include <system_error>
 
 #ifdef _WIN32
 # include <Windows.h>
 #else
 // assume POSIX
-# include <sys/mman.h> // for mmap(), munmap(), madvise()
+# include <sys/mman.h> // for mmap(), munmap(), mremap(), madvise()
+# if defined(__linux__)
+#  include <unistd.h>       // for syscall()
+#  include <sys/syscall.h>  // for SYS_mbind
+# endif // defined(__linux__)
 #endif
 
 #include <gsl-lite/gsl-lite.hpp>  // for gsl_Assert(), gsl_FailFast()
 
 #include <patton/new.hpp>    // for hardware_large_page_size(), hardware_page_size(), hardware_cache_line_size()
+#include <patton/thread.hpp> // for numa_node_count()
 #include <patton/memory.hpp>
 
 #include <patton/detail/arithmetic.hpp> // for try_ceili()
 #include <patton/detail/errors.hpp>
+#include <patton/detail/cpuinfo.hpp>  // for numa_node_os_id()
 
 
 namespace patton::detail {
@@ -66,8 +84,27 @@ aligned_free(void* data, std::size_t size, std::size_t alignment) noexcept
     return ::operator delete(data, size, std::align_val_t(alignment));
 }
 
+    // Faults in the pages of a fresh allocation, releasing the allocation if this fails.
+static void
+populate_or_release(void* data, std::size_t allocSize)
+{
+    try
+    {
+        patton::prefault_pages(data, allocSize);
+    }
+    catch (...)
+    {
+#if defined(_WIN32)
+        ::VirtualFree(data, 0, MEM_RELEASE);
+#else // assume POSIX
+        ::munmap(data, allocSize);
+#endif
+        throw;
+    }
+}
+
 void*
-large_page_alloc([[maybe_unused]] std::size_t size)
+large_page_alloc([[maybe_unused]] std::size_t size, [[maybe_unused]] bool populate)
 {
 #if defined(__linux__) || defined(_WIN32)
     std::size_t largePageSize = hardware_large_page_size();
@@ -88,10 +125,16 @@ large_page_alloc([[maybe_unused]] std::size_t size)
             ::munmap(data, fullSizeR.value);
             detail::posix_raise(ec);
         }
+        if (populate)
+        {
+                // We do not use `MAP_POPULATE` because the pages would be faulted in before `madvise()` is called.
+            detail::populate_or_release(data, fullSizeR.value);
+        }
         detail::set_out_of_bounds_write_trap(data, size, fullSizeR.value);
         return data;
 # elif defined(_WIN32)
         // TODO: should we do anything about the privileges here? (cf. https://docs.microsoft.com/en-us/windows/win32/memory/large-page-support, https://stackoverflow.com/a/42380052)
+            // Large pages are non-pageable on Windows and hence always resident, so there is nothing to populate.
         void* data = ::VirtualAlloc(NULL, fullSizeR.value, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
         detail::win32_assert(data != nullptr);
         detail::set_out_of_bounds_write_trap(data, size, fullSizeR.value);
@@ -121,8 +164,79 @@ large_page_free([[maybe_unused]] void* data, [[maybe_unused]] std::size_t size)
 #endif
 }
 
+static std::size_t
+explicit_large_page_size(std::size_t pageSize)
+{
+    if (pageSize == 0)
+    {
+        pageSize = hardware_large_page_size();
+    }
+    auto pageSizes = hardware_large_page_sizes();
+    if (pageSize == 0 || std::find(pageSizes.begin(), pageSizes.end(), pageSize) == pageSizes.end())
+    {
+        throw std::system_error(std::make_error_code(std::errc::not_supported));
+    }
+    return pageSize;
+}
+
+void*
+explicit_large_page_alloc(std::size_t size, std::size_t pageSize, [[maybe_unused]] bool populate)
+{
+    pageSize = detail::explicit_large_page_size(pageSize);
+    auto fullSizeR = detail::try_ceili(size, pageSize);
+    if (fullSizeR.ec != std::errc{ })
+    {
+        throw std::bad_alloc{ };
+    }
+    void* data;
+#if defined(__linux__)
+# ifndef MAP_HUGE_SHIFT
+#  define MAP_HUGE_SHIFT 26
+# endif // MAP_HUGE_SHIFT
+    int log2PageSize = 0;
+    while ((std::size_t(1) << log2PageSize) < pageSize) ++log2PageSize;
+    data = ::mmap(NULL, fullSizeR.value, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (log2PageSize << MAP_HUGE_SHIFT) | (populate ? MAP_POPULATE : 0), -1, 0);
+    if (data == MAP_FAILED)
+    {
+            // The kernel reserves the large pages when the mapping is created, so `ENOMEM` indicates that the pool of
+            // large pages of the given size is exhausted.
+        if (errno == ENOMEM) throw std::bad_alloc{ };
+        detail::posix_raise_last_error();
+    }
+#elif defined(_WIN32)
+        // Large pages are non-pageable on Windows and hence always resident, so there is nothing to populate.
+    data = ::VirtualAlloc(NULL, fullSizeR.value, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    detail::win32_assert(data != nullptr);
+#else
+    (void) data;
+    throw std::system_error(std::make_error_code(std::errc::not_supported));  // should not happen because the list of supported page sizes is empty
+#endif
+    detail::set_out_of_bounds_write_trap(data, size, fullSizeR.value);
+    return data;
+}
+void
+explicit_large_page_free(void* data, std::size_t size, std::size_t pageSize) noexcept
+{
+    if (pageSize == 0)
+    {
+        pageSize = hardware_large_page_size();
+    }
+    auto allocSizeR = detail::try_ceili(size, pageSize);
+    gsl_Assert(allocSizeR.ec == std::errc{ });
+    if (!detail::check_out_of_bounds_write_trap(data, size, allocSizeR.value))
+    {
+        gsl_FailFast();  // an out-of-bounds write has damaged this allocation
+    }
+#if defined(_WIN32)
+    detail::win32_assert(::VirtualFree(data, 0, MEM_RELEASE));
+#else // assume POSIX
+    detail::posix_assert(::munmap(data, allocSizeR.value) == 0);
+#endif
+}
+
 void*
-page_alloc(std::size_t size)
+page_alloc(std::size_t size, bool populate)
 {
     std::size_t pageSize = hardware_page_size();
     gsl_Assert(pageSize != 0);
@@ -148,6 +262,11 @@ page_alloc(std::size_t size)
     }
 # endif // defined(__linux__)
 #endif
+    if (populate)
+    {
+            // We do not use `MAP_POPULATE` because the pages would be faulted in before `madvise()` is called.
+        detail::populate_or_release(data, fullSizeR.value);
+    }
     detail::set_out_of_bounds_write_trap(data, size, fullSizeR.value);
     return data;
 }
@@ -166,6 +285,338 @@ page_free(void* data, std::size_t size) noexcept
     detail::posix_assert(::munmap(data, size) == 0);
 #endif
 }
+void*
+page_realloc(void* data, std::size_t oldSize, std::size_t newSize, bool populate)
+{
+#if defined(__linux__)
+    std::size_t pageSize = hardware_page_size();
+    auto oldFullSizeR = detail::try_ceili(oldSize, pageSize);
+    gsl_Assert(oldFullSizeR.ec == std::errc{ });
+    auto newFullSizeR = detail::try_ceili(newSize, pageSize);
+    if (newFullSizeR.ec != std::errc{ })
+    {
+        throw std::bad_alloc{ };
+    }
+    if (!detail::check_out_of_bounds_write_trap(data, oldSize, oldFullSizeR.value))
+    {
+        gsl_FailFast();  // an out-of-bounds write has damaged this allocation
+    }
+    void* newData = data;
+    if (newFullSizeR.value != oldFullSizeR.value)
+    {
+            // The kernel moves the page table entries rather than copying the contents, so the old and the new mapping
+            // never coexist. The mapping retains its `madvise()` flags.
+        newData = ::mremap(data, oldFullSizeR.value, newFullSizeR.value, MREMAP_MAYMOVE);
+        if (newData == MAP_FAILED)
+        {
+            int ec = errno;
+            if (ec == ENOMEM) throw std::bad_alloc{ };
+            detail::posix_raise(ec);
+        }
+        if (populate && newFullSizeR.value > oldFullSizeR.value)
+        {
+            try
+            {
+                patton::prefault_pages(static_cast<char*>(newData) + oldFullSizeR.value, newFullSizeR.value - oldFullSizeR.value);
+            }
+            catch (...)
+            {
+                    // The allocation has already been resized. Pages which could not be populated will be faulted in lazily.
+            }
+        }
+    }
+    detail::set_out_of_bounds_write_trap(newData, newSize, newFullSizeR.value);
+    return newData;
+#else // !defined(__linux__)
+        // Without `mremap()`, we have to allocate new pages and copy the contents.
+    void* newData = detail::page_alloc(newSize, populate);
+    std::memcpy(newData, data, std::min(oldSize, newSize));
+    detail::page_free(data, oldSize);
+    return newData;
+#endif // defined(__linux__)
+}
+
+
+#if defined(__linux__)
+    // Memory policy constants from <linux/mempolicy.h>, which we do not include to avoid depending on kernel headers.
+constexpr int mpolBind = 2;        // MPOL_BIND
+constexpr int mpolInterleave = 3;  // MPOL_INTERLEAVE
+constexpr unsigned mpolMfMove = 1u << 1;  // MPOL_MF_MOVE
+
+static void
+numa_bind_pages(void* data, std::size_t size, int node) noexcept
+{
+    int numNodes = patton::numa_node_count();
+    if (numNodes <= 1) return;  // nothing to do
+
+    constexpr int bitsPerWord = sizeof(unsigned long)*CHAR_BIT;
+    int maxOsId = 0;
+    for (int i = 0; i < numNodes; ++i)
+    {
+        maxOsId = std::max(maxOsId, detail::numa_node_os_id(i));
+    }
+    auto nodeMask = std::vector<unsigned long>(std::size_t(maxOsId/bitsPerWord + 1));
+    auto addToMask = [&nodeMask](int osId)
+    {
+        nodeMask[osId/bitsPerWord] |= 1ul << (osId % bitsPerWord);
+    };
+    if (node == numa_interleaved)
+    {
+        for (int i = 0; i < numNodes; ++i)
+        {
+            addToMask(detail::numa_node_os_id(i));
+        }
+    }
+    else
+    {
+        addToMask(detail::numa_node_os_id(node));
+    }
+
+        // The kernel ignores the last bit of the node mask, so we pass one more than the number of bits.
+        // `MPOL_MF_MOVE` migrates the page already touched by `set_out_of_bounds_write_trap()`.
+        // Binding is best-effort: if the kernel was built without NUMA support (`ENOSYS`), or if we are not permitted to
+        // set the memory policy (`EPERM`), or if the nodes are not available to us (`EINVAL`), the allocation remains
+        // unbound, hence we ignore the result.
+    unsigned long maxNode = nodeMask.size()*bitsPerWord + 1;
+    ::syscall(SYS_mbind, data, size, node == numa_interleaved ? mpolInterleave : mpolBind,
+        nodeMask.data(), maxNode, mpolMfMove);
+}
+#endif // defined(__linux__)
+
+void*
+numa_page_alloc(std::size_t size, int node)
+{
+    gsl_Expects(node == numa_interleaved || (node >= 0 && node < patton::numa_node_count()));
+
+    void* data = detail::page_alloc(size);
+#if defined(__linux__)
+        // Set the memory policy before the pages are first touched by the caller so they are placed on the designated nodes.
+    std::size_t pageSize = hardware_page_size();
+    auto fullSizeR = detail::try_ceili(size, pageSize);
+    gsl_Assert(fullSizeR.ec == std::errc{ });  // already checked by `page_alloc()`
+    detail::numa_bind_pages(data, fullSizeR.value, node);
+#endif // defined(__linux__)
+    return data;
+}
+
+
+class block_pool
+{
+public:
+    struct batch
+    {
+        void* head;  // free blocks are linked through their first word
+        std::size_t count;
+    };
+
+    std::size_t const blockSize;
+    std::size_t const alignment;
+    std::size_t const index;      // index into the thread-local caches
+    std::size_t const batchSize;  // number of blocks exchanged between the thread-local caches and the depot at once
+
+    block_pool(std::size_t _blockSize, std::size_t _alignment, std::size_t _index) noexcept
+        : blockSize(_blockSize), alignment(_alignment), index(_index),
+          batchSize(std::clamp(std::size_t(16384) / _blockSize, std::size_t(1), std::size_t(64)))
+    {
+    }
+
+    batch
+    acquire_batch()
+    {
+        auto lock = std::lock_guard(mutex_);
+        if (!depot_.empty())
+        {
+            batch result = depot_.back();
+            depot_.pop_back();
+            return result;
+        }
+
+            // Carve a new batch of blocks from the current slab, allocating a new slab if necessary. Slabs are page-aligned,
+            // and the block size is a multiple of the alignment, hence all blocks are suitably aligned.
+        if (std::size_t(slabEnd_ - slabBegin_) < batchSize*blockSize)
+        {
+            std::size_t slabSize = std::max(std::size_t(65536), batchSize*blockSize);
+            slabBegin_ = static_cast<char*>(detail::page_alloc(slabSize));
+            slabEnd_ = slabBegin_ + slabSize;
+        }
+        void* head = nullptr;
+        for (std::size_t i = 0; i < batchSize; ++i)
+        {
+            slabEnd_ -= blockSize;
+            *static_cast<void**>(static_cast<void*>(slabEnd_)) = head;
+            head = slabEnd_;
+        }
+        return { head, batchSize };
+    }
+    void
+    release_batch(batch b)
+    {
+        auto lock = std::lock_guard(mutex_);
+        depot_.push_back(b);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<batch> depot_;
+    char* slabBegin_ = nullptr;  // remaining part of the current slab
+    char* slabEnd_ = nullptr;
+};
+
+struct block_pool_registry
+{
+    std::mutex mutex;
+    std::vector<block_pool*> pools;  // never deallocated because thread-local caches may refer to them during shutdown
+};
+static block_pool_registry&
+get_block_pool_registry()
+{
+    static auto& registry = *new block_pool_registry{ };
+    return registry;
+}
+
+block_pool&
+get_block_pool(std::size_t blockSize, std::size_t alignment)
+{
+    gsl_Expects(alignment <= hardware_page_size());
+    gsl_Expects(blockSize % alignment == 0);
+
+    auto& registry = detail::get_block_pool_registry();
+    auto lock = std::lock_guard(registry.mutex);
+    for (block_pool* pool : registry.pools)
+    {
+        if (pool->blockSize == blockSize && pool->alignment == alignment)
+        {
+            return *pool;
+        }
+    }
+    auto pool = std::make_unique<block_pool>(blockSize, alignment, registry.pools.size());
+    registry.pools.push_back(pool.get());
+    return *pool.release();
+}
+
+class block_pool_thread_caches
+{
+private:
+    std::vector<block_pool::batch> caches_;  // indexed by `block_pool::index`
+    std::vector<block_pool*> pools_;
+
+public:
+    block_pool::batch&
+    cache(block_pool& pool)
+    {
+        if (pool.index >= caches_.size())
+        {
+            caches_.resize(pool.index + 1, block_pool::batch{ nullptr, 0 });
+            pools_.resize(pool.index + 1, nullptr);
+        }
+        pools_[pool.index] = &pool;
+        return caches_[pool.index];
+    }
+
+    ~block_pool_thread_caches()
+    {
+            // Return cached blocks to the depots so other threads can reuse them.
+        for (std::size_t i = 0; i < caches_.size(); ++i)
+        {
+            if (caches_[i].count != 0)
+            {
+                pools_[i]->release_batch(caches_[i]);
+            }
+        }
+    }
+};
+
+    // Blocks may be allocated and freed after the thread-local caches of the current thread have been torn down, e.g. by
+    // destructors of static objects, which run after the thread-local destructors of the main thread, or of thread-local objects
+    // destroyed later. We therefore refer to the caches through trivially destructible thread-local variables, and a separate
+    // guard object tears the caches down when the thread exits.
+static thread_local block_pool_thread_caches* blockPoolThreadCaches = nullptr;
+static thread_local bool blockPoolThreadCachesTornDown = false;
+
+struct block_pool_thread_caches_guard
+{
+    void
+    arm() noexcept
+    {
+    }
+
+    ~block_pool_thread_caches_guard()
+    {
+        blockPoolThreadCachesTornDown = true;
+        delete std::exchange(blockPoolThreadCaches, nullptr);
+    }
+};
+static thread_local block_pool_thread_caches_guard blockPoolThreadCachesGuard;
+
+    // Returns the thread-local caches of the current thread, or `nullptr` if they have already been torn down.
+static block_pool_thread_caches*
+get_block_pool_thread_caches()
+{
+    if (blockPoolThreadCaches == nullptr && !blockPoolThreadCachesTornDown)
+    {
+        blockPoolThreadCachesGuard.arm();  // registers the destructor of the guard
+        blockPoolThreadCaches = new block_pool_thread_caches{ };
+    }
+    return blockPoolThreadCaches;
+}
+
+void*
+block_pool_alloc(block_pool& pool)
+{
+    auto caches = detail::get_block_pool_thread_caches();
+    if (caches == nullptr)
+    {
+            // The caches have been torn down, so we take a single block from the depot.
+        auto b = pool.acquire_batch();
+        void* block = b.head;
+        if (b.count > 1)
+        {
+            pool.release_batch(block_pool::batch{ *static_cast<void**>(block), b.count - 1 });
+        }
+        return block;
+    }
+    auto& cache = caches->cache(pool);
+    if (cache.count == 0)
+    {
+        cache = pool.acquire_batch();
+    }
+    void* block = cache.head;
+    cache.head = *static_cast<void**>(block);
+    --cache.count;
+    return block;
+}
+void
+block_pool_free(block_pool& pool, void* block) noexcept
+{
+        // If the block was allocated by another thread, this may be the first time the current thread uses the pool, in which
+        // case setting up the thread-local cache may fail to allocate memory and thus terminate.
+    auto caches = detail::get_block_pool_thread_caches();
+    if (caches == nullptr)
+    {
+            // The caches have been torn down, so we return the block to the depot right away.
+        *static_cast<void**>(block) = nullptr;
+        pool.release_batch(block_pool::batch{ block, 1 });
+        return;
+    }
+    auto& cache = caches->cache(pool);
+    *static_cast<void**>(block) = cache.head;
+    cache.head = block;
+    ++cache.count;
+    if (cache.count == 2*pool.batchSize)
+    {
+            // Return one batch to the depot.
+        void* last = cache.head;
+        for (std::size_t i = 1; i < pool.batchSize; ++i)
+        {
+            last = *static_cast<void**>(last);
+        }
+        auto b = block_pool::batch{ cache.head, pool.batchSize };
+        cache.head = *static_cast<void**>(last);
+        *static_cast<void**>(last) = nullptr;
+        cache.count -= pool.batchSize;
+        pool.release_batch(b);
+    }
+}
 
 
 std::size_t
@@ -198,3 +649,104 @@ alignment_in_bytes(std::size_t a) noexcept
 
 
 } // namespace patton::detail
+
+namespace patton {
+
+
+void
+prefault_pages(void* data, std::size_t size)
+{
+    if (size == 0) return;
+
+    std::size_t pageSize = hardware_page_size();
+    auto first = reinterpret_cast<std::uintptr_t>(data) & ~std::uintptr_t(pageSize - 1);
+    auto last = reinterpret_cast<std::uintptr_t>(data) + size;
+
+#if defined(__linux__)
+# ifndef MADV_POPULATE_WRITE
+#  define MADV_POPULATE_WRITE 23  // available since Linux 5.14
+# endif // MADV_POPULATE_WRITE
+    int ec = ::madvise(reinterpret_cast<void*>(first), last - first, MADV_POPULATE_WRITE);
+    if (ec == 0) return;
+    ec = errno;
+    if (ec != EINVAL) detail::posix_raise(ec);  // `EINVAL` indicates that the kernel does not support `MADV_POPULATE_WRITE`
+#endif // defined(__linux__)
+
+        // Touch every page with an atomic no-op write which preserves the contents even if other threads access the memory.
+    for (std::uintptr_t p = first; p < last; p += pageSize)
+    {
+        auto pageBegin = reinterpret_cast<char*>(std::max(p, reinterpret_cast<std::uintptr_t>(data)));
+        std::atomic_ref<char>(*pageBegin).fetch_or(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t
+large_page_backed_size([[maybe_unused]] void const* data, [[maybe_unused]] std::size_t size)
+{
+#if defined(__linux__)
+        // Walk the mappings listed in /proc/self/smaps and accumulate the large-page-backed portions of those which
+        // overlap the given range. Mappings of explicit large pages have a kernel page size larger than the base page size;
+        // for other mappings, the "AnonHugePages" entry counts the memory backed by transparent huge pages.
+    auto f = std::ifstream("/proc/self/smaps");
+    if (!f) throw std::runtime_error("cannot open /proc/self/smaps");
+
+    auto first = reinterpret_cast<std::uintptr_t>(data);
+    auto last = first + size;
+    std::size_t pageSize = hardware_page_size();
+    std::size_t result = 0;
+    std::size_t overlap = 0;
+    std::size_t kernelPageSize = 0;
+    std::size_t anonHugePages = 0;
+    auto flush = [&]
+    {
+        if (overlap != 0)
+        {
+            result += kernelPageSize > pageSize ? overlap : std::min(overlap, anonHugePages);
+        }
+    };
+    auto line = std::string{ };
+    while (std::getline(f, line))
+    {
+        unsigned long long mapFirst, mapLast;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &mapFirst, &mapLast) == 2)
+        {
+            flush();
+            overlap = 0;
+            kernelPageSize = 0;
+            anonHugePages = 0;
+            std::uintptr_t overlapFirst = std::max(first, std::uintptr_t(mapFirst));
+            std::uintptr_t overlapLast = std::min(last, std::uintptr_t(mapLast));
+            if (overlapFirst < overlapLast)
+            {
+                overlap = overlapLast - overlapFirst;
+            }
+            continue;
+        }
+        if (overlap == 0) continue;
+
+        char name[32+1];
+        unsigned long long value;
+        char unit[16+1];
+        if (std::sscanf(line.c_str(), "%32[^:]: %llu %16s", name, &value, unit) == 3)
+        {
+                // This is the only unit the kernel currently emits.
+            if (std::strcmp(unit, "kB") != 0) throw std::runtime_error("error parsing /proc/self/smaps: unrecognized unit '" + std::string(unit) + "'");
+            if (std::strcmp(name, "KernelPageSize") == 0)
+            {
+                kernelPageSize = gsl::narrow<std::size_t>(value*1024);
+            }
+            else if (std::strcmp(name, "AnonHugePages") == 0)
+            {
+                anonHugePages = gsl::narrow<std::size_t>(value*1024);
+            }
+        }
+    }
+    flush();
+    return result;
+#else // ^^^ defined(__linux__) ^^^ / vvv !defined(__linux__) vvv
+    throw std::system_error(std::make_error_code(std::errc::not_supported));
+#endif // defined(__linux__)
+}
+
+
+} // namespace patton
@@ -0,0 +1,159 @@
+
+#include <new>              // for bad_alloc, align_val_t
+#include <limits>
+#include <cstddef>          // for size_t, max_align_t
+#include <cstdint>          // for uintptr_t
+#include <algorithm>        // for max()
+#include <memory_resource>
+
+#include <gsl-lite/gsl-lite.hpp>  // for gsl_Expects()
+
+#include <patton/new.hpp>  // for hardware_page_size()
+#include <patton/memory.hpp>
+#include <patton/memory_resource.hpp>
+
+#include <patton/detail/memory.hpp>  // for alignment_in_bytes(), aligned_alloc(), page_alloc(), large_page_alloc()
+
+
+namespace patton {
+
+
+void*
+aligned_memory_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    return detail::aligned_alloc(bytes, detail::alignment_in_bytes(alignment_ | alignment));
+}
+void
+aligned_memory_resource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+    detail::aligned_free(ptr, bytes, detail::alignment_in_bytes(alignment_ | alignment));
+}
+bool
+aligned_memory_resource::do_is_equal(std::pmr::memory_resource const& rhs) const noexcept
+{
+    auto rhsResource = dynamic_cast<aligned_memory_resource const*>(&rhs);
+    return rhsResource != nullptr && rhsResource->alignment_ == alignment_;
+}
+
+
+    // Pages cannot be mapped with a size of 0, so we allocate at least one byte.
+static std::size_t
+nonzero_size(std::size_t bytes) noexcept
+{
+    return std::max(bytes, std::size_t(1));
+}
+
+void*
+page_memory_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (alignment > hardware_page_size()) throw std::bad_alloc{ };
+    return detail::page_alloc(nonzero_size(bytes), options_ == page_options::populate);
+}
+void
+page_memory_resource::do_deallocate(void* ptr, std::size_t bytes, std::size_t /*alignment*/)
+{
+    detail::page_free(ptr, nonzero_size(bytes));
+}
+bool
+page_memory_resource::do_is_equal(std::pmr::memory_resource const& rhs) const noexcept
+{
+        // The options only affect allocation, hence any page memory resource can deallocate memory obtained by another.
+    return dynamic_cast<page_memory_resource const*>(&rhs) != nullptr;
+}
+
+
+void*
+large_page_memory_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (alignment > hardware_page_size()) throw std::bad_alloc{ };
+    return detail::large_page_alloc(nonzero_size(bytes), options_ == page_options::populate);
+}
+void
+large_page_memory_resource::do_deallocate(void* ptr, std::size_t bytes, std::size_t /*alignment*/)
+{
+    detail::large_page_free(ptr, nonzero_size(bytes));
+}
+bool
+large_page_memory_resource::do_is_equal(std::pmr::memory_resource const& rhs) const noexcept
+{
+        // The options only affect allocation, hence any large page memory resource can deallocate memory obtained by another.
+    return dynamic_cast<large_page_memory_resource const*>(&rhs) != nullptr;
+}
+
+
+    // Stored at the end of every chunk so that the beginning of the chunk retains the alignment of the upstream allocation.
+struct aligned_monotonic_buffer_resource::chunk_header
+{
+    chunk_header* prev;
+    std::size_t size;  // including the header
+};
+
+aligned_monotonic_buffer_resource::aligned_monotonic_buffer_resource(std::size_t _alignment, std::size_t _initialSize,
+    std::pmr::memory_resource* _upstream) noexcept
+    : upstream_(_upstream), alignment_(_alignment), nextChunkSize_(_initialSize), chunks_(nullptr), next_(nullptr), end_(nullptr)
+{
+    gsl_Expects(_upstream != nullptr);
+}
+aligned_monotonic_buffer_resource::~aligned_monotonic_buffer_resource()
+{
+    release();
+}
+
+void
+aligned_monotonic_buffer_resource::release() noexcept
+{
+    std::size_t chunkAlignment = detail::alignment_in_bytes(alignment_ | alignof(chunk_header));
+    while (chunks_ != nullptr)
+    {
+        chunk_header* prev = chunks_->prev;
+        std::size_t size = chunks_->size;
+        char* chunk = reinterpret_cast<char*>(chunks_ + 1) - size;
+        upstream_->deallocate(chunk, size, chunkAlignment);
+        chunks_ = prev;
+    }
+    next_ = nullptr;
+    end_ = nullptr;
+}
+
+void*
+aligned_monotonic_buffer_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    std::size_t a = detail::alignment_in_bytes(alignment_ | alignment);
+    std::size_t padding = std::size_t(-reinterpret_cast<std::uintptr_t>(next_)) & (a - 1);
+    std::size_t remaining = std::size_t(end_ - next_);
+    if (next_ == nullptr || padding > remaining || bytes > remaining - padding)
+    {
+            // Obtain a new chunk from the upstream resource which can hold the allocation and the chunk header.
+        constexpr std::size_t maxSize = std::numeric_limits<std::size_t>::max();
+        std::size_t chunkAlignment = detail::alignment_in_bytes(alignment_ | alignof(chunk_header));
+        if (bytes > maxSize - a - sizeof(chunk_header) - chunkAlignment) throw std::bad_alloc{ };  // overflow
+        std::size_t minSize = bytes + a + sizeof(chunk_header);
+        std::size_t size = std::max(nextChunkSize_, minSize);
+        size = (size + (chunkAlignment - 1)) & ~(chunkAlignment - 1);
+        char* chunk = static_cast<char*>(upstream_->allocate(size, chunkAlignment));
+        auto header = reinterpret_cast<chunk_header*>(chunk + size) - 1;
+        *header = chunk_header{ chunks_, size };
+        chunks_ = header;
+        next_ = chunk;
+        end_ = reinterpret_cast<char*>(header);
+        nextChunkSize_ = size <= maxSize/2 ? 2*size : size;
+
+        padding = std::size_t(-reinterpret_cast<std::uintptr_t>(next_)) & (a - 1);
+    }
+    char* result = next_ + padding;
+    next_ = result + bytes;
+    return result;
+}
+void
+aligned_monotonic_buffer_resource::do_deallocate(void* /*ptr*/, std::size_t /*bytes*/, std::size_t /*alignment*/)
+{
+        // Memory is released only by `release()`.
+}
+bool
+aligned_monotonic_buffer_resource::do_is_equal(std::pmr::memory_resource const& rhs) const noexcept
+{
+    return this == &rhs;
+}
+
+
+} // namespace patton
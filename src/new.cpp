@@ -4,8 +4,12 @@
 #include <cstdlib>    // for sscanf()
 #include <cstddef>    // for size_t
 #include <cstring>    // for strcmp()
+#include <span>
 #include <string>
+#include <vector>
 #include <fstream>
+#include <algorithm>  // for sort()
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>  // for runtime_error
 
@@ -89,6 +93,44 @@ hardware_large_page_size() noexcept
 }
 
 
+std::span<std::size_t const>
+hardware_large_page_sizes() noexcept
+{
+    static auto const sizes = []
+    {
+        auto result = std::vector<std::size_t>{ };
+#if defined(_WIN32)
+        std::size_t largePageSize = GetLargePageMinimum();
+        if (largePageSize != 0)
+        {
+            result.push_back(largePageSize);
+        }
+#elif defined(__linux__)
+            // The kernel lists every supported size as a directory named "hugepages-<size>kB".
+        auto ec = std::error_code{ };
+        for (auto it = std::filesystem::directory_iterator("/sys/kernel/mm/hugepages", ec);
+             !ec && it != std::filesystem::directory_iterator{ }; it.increment(ec))
+        {
+            long hugePageSizeInKiB = 0;
+            char unit[2+1];
+            int nFields = std::sscanf(it->path().filename().c_str(), "hugepages-%ld%2s", &hugePageSizeInKiB, unit);
+            if (nFields == 2 && std::strcmp(unit, "kB") == 0 && hugePageSizeInKiB > 0)
+            {
+                result.push_back(gsl::narrow_failfast<std::size_t>(hugePageSizeInKiB)*1024);
+            }
+        }
+        std::sort(result.begin(), result.end());
+#elif defined(__APPLE__)
+        // MacOS does support huge pages ("superpages") but we currently didn't write any code to support them
+#else
+# error Unsupported operating system.
+#endif
+        return result;
+    }();
+    return sizes;
+}
+
+
 static std::atomic<std::size_t>
 hardware_page_size_value = std::size_t(-1);
 
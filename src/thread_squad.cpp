@@ -10,12 +10,18 @@
 #include <new>
 #include <string>
 #include <memory>        // for unique_ptr<>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <tuple>
 #include <thread>
+#include <vector>
 #include <cstddef>       // for size_t, ptrdiff_t
+#include <cstdint>       // for uint32_t, uint64_t
 #include <cstring>       // for wcslen(), swprintf()
-#include <utility>       // for move()
-#include <algorithm>     // for min()
+#include <bit>           // for bit_cast<>()
+#include <utility>       // for move(), exchange()
+#include <algorithm>     // for min(), sort(), find(), lower_bound()
 #include <exception>     // for terminate()
 #include <stdexcept>     // for range_error
 #include <type_traits>   // for remove_pointer<>
@@ -40,6 +46,14 @@
 
 #if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
 # include <emmintrin.h>
+# if defined(__GNUC__) || defined(__clang__)
+#  define UMWAIT_SUPPORTED
+#  include <cpuid.h>      // __get_cpuid_count()
+#  include <x86intrin.h>  // __rdtsc()
+#  include <immintrin.h>  // _umonitor(), _umwait()
+# endif // defined(__GNUC__) || defined(__clang__)
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+# define WFE_SUPPORTED
 #endif // defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
 
 #if defined(_WIN32) || defined(USE_PTHREAD_SETAFFINITY)
@@ -48,10 +62,14 @@
 
 #include <gsl-lite/gsl-lite.hpp>  // for index, narrow_failfast<>(), narrow_cast<>()
 
+#include <patton/new.hpp>           // for hardware_page_size()
+#include <patton/memory.hpp>        // for arena
 #include <patton/buffer.hpp>        // for aligned_buffer<>
 #include <patton/thread_squad.hpp>
 
 #include <patton/detail/errors.hpp>
+#include <patton/detail/arithmetic.hpp>  // for try_ceili()
+#include <patton/detail/cpuinfo.hpp>  // for hardware_thread_infos()
 
 
 #ifdef _MSC_VER
@@ -309,17 +327,19 @@ pause() noexcept
 
 constexpr int spinCount = 6;  // 4 or 6
 constexpr int spinRep = 1;  // 2 or 1
-constexpr int pauseCountExp = 9;
-constexpr int smtPauseCountExp = 9;
 constexpr int yieldCountExp = 0;  // 6
 
+    // Spin durations before yielding and blocking. The latency of the `pause` instruction varies from about 10 to about 140
+    // cycles across processor generations, so the corresponding numbers of loop iterations are calibrated at runtime.
+constexpr auto spinDuration = std::chrono::nanoseconds(20'000);
+constexpr auto smtSpinDuration = std::chrono::nanoseconds(10'000);
+
 template <typename T>
 bool
-wait_equal_exponential_backoff(std::atomic<T> const& a, T oldValue) noexcept
+spin_equal_exponential_backoff(std::atomic<T> const& a, T oldValue, int iterationCount) noexcept
 {
     int lspinCount = spinCount;
-    if (a.load(std::memory_order_relaxed) != oldValue) return true;
-    for (int i = 0; i < (1 << pauseCountExp); ++i)
+    for (int i = 0; i < iterationCount; ++i)
     {
         int n = 1;
         for (int j = 0; j < lspinCount; ++j)
@@ -337,6 +357,25 @@ wait_equal_exponential_backoff(std::atomic<T> const& a, T oldValue) noexcept
         if (a.load(std::memory_order_relaxed) != oldValue) return true;
         detail::pause();
     }
+    return false;
+}
+
+template <typename T>
+bool
+spin_equal(std::atomic<T> const& a, T oldValue, int pauseCount) noexcept
+{
+    for (int i = 0; i < pauseCount; ++i)
+    {
+        if (a.load(std::memory_order_relaxed) != oldValue) return true;
+        detail::pause();
+    }
+    return false;
+}
+
+template <typename T>
+bool
+yield_equal(std::atomic<T> const& a, T oldValue) noexcept
+{
     int lyieldCount = 1 << yieldCountExp;
     for (int i = 0; i < lyieldCount; ++i)
     {
@@ -346,30 +385,276 @@ wait_equal_exponential_backoff(std::atomic<T> const& a, T oldValue) noexcept
     return false;
 }
 
+#if defined(UMWAIT_SUPPORTED)
+    // Waits until the cache line of `a` is written to or until the TSC deadline has passed. `umwait` lets the SMT sibling
+    // use the execution resources of the core and saves power; we request the C0.1 state, which has the shorter wake-up
+    // latency. The operating system may limit the wait time, in which case we simply wait again.
+template <typename T>
+[[gnu::target("waitpkg")]] bool
+monitored_wait_equal(std::atomic<T> const& a, T oldValue, std::uint64_t ticks) noexcept
+{
+    constexpr unsigned umwaitC01 = 1;
+
+    std::uint64_t deadline = __rdtsc() + ticks;
+    for (;;)
+    {
+        _umonitor(const_cast<std::atomic<T>*>(&a));
+        if (a.load(std::memory_order_relaxed) != oldValue) return true;
+        _umwait(umwaitC01, deadline);
+        if (a.load(std::memory_order_relaxed) != oldValue) return true;
+        if (__rdtsc() >= deadline) return false;
+    }
+}
+
+std::uint64_t
+monitored_wait_counter() noexcept
+{
+    return __rdtsc();
+}
+
+bool
+monitored_wait_supported() noexcept
+{
+        // WAITPKG is indicated by CPUID.(EAX=07H, ECX=0H):ECX[bit 5].
+    unsigned eax, ebx, ecx, edx;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 && (ecx & (1u << 5)) != 0;
+}
+#elif defined(WFE_SUPPORTED)
+template <typename T>
+T
+load_exclusive(std::atomic<T> const& a) noexcept
+{
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+
+    if constexpr (sizeof(T) == 4)
+    {
+        std::uint32_t value;
+        __asm__ volatile("ldxr %w0, [%1]" : "=r" (value) : "r" (&a) : "memory");
+        return std::bit_cast<T>(value);
+    }
+    else
+    {
+        std::uint64_t value;
+        __asm__ volatile("ldxr %0, [%1]" : "=r" (value) : "r" (&a) : "memory");
+        return std::bit_cast<T>(value);
+    }
+}
+
+std::uint64_t
+monitored_wait_counter() noexcept
+{
+    std::uint64_t value;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r" (value));
+    return value;
+}
+
+    // Waits until the cache line of `a` is written to or until the deadline of the virtual counter has passed. The exclusive
+    // load arms the exclusive monitor; a write by another thread clears it and generates the event that ends `wfe`. Because
+    // the operating system generates periodic events (every 100 μs on Linux), the deadline may be overshot by that much.
+template <typename T>
+bool
+monitored_wait_equal(std::atomic<T> const& a, T oldValue, std::uint64_t ticks) noexcept
+{
+    std::uint64_t deadline = detail::monitored_wait_counter() + ticks;
+    for (;;)
+    {
+        if (detail::load_exclusive(a) != oldValue) return true;
+        __asm__ volatile("wfe" ::: "memory");
+        if (a.load(std::memory_order_relaxed) != oldValue) return true;
+        if (detail::monitored_wait_counter() >= deadline) return false;
+    }
+}
+
+bool
+monitored_wait_supported() noexcept
+{
+    return true;
+}
+#endif // defined(UMWAIT_SUPPORTED)
+
+struct spin_calibration
+{
+    double backoffIterationNanoseconds;  // duration of an iteration of `spin_equal_exponential_backoff()`
+    double pauseNanoseconds;             // duration of an iteration of `spin_equal()`
+
+    int backoffIterationCount;  // number of iterations of `spin_equal_exponential_backoff()` which take `spinDuration`
+
+    bool haveMonitoredWait;                // whether `monitored_wait_equal()` can be used
+    double monitoredWaitTicksPerNanosecond;  // frequency of `monitored_wait_counter()`
+
+    int
+    pause_count(std::chrono::nanoseconds duration) const noexcept
+    {
+        return iteration_count(duration, pauseNanoseconds);
+    }
+
+    std::uint64_t
+    monitored_wait_ticks(std::chrono::nanoseconds duration) const noexcept
+    {
+        return static_cast<std::uint64_t>(double(duration.count())*monitoredWaitTicksPerNanosecond);
+    }
+
+    static int
+    iteration_count(std::chrono::nanoseconds duration, double nanosecondsPerIteration) noexcept
+    {
+        constexpr double maxIterationCount = 1 << 24;
+        return static_cast<int>(std::clamp(double(duration.count())/nanosecondsPerIteration, 1., maxIterationCount));
+    }
+};
+
+template <typename SpinFuncT>
+double
+measure_spin_iteration(SpinFuncT spin) noexcept
+{
+        // Spin on a value which never changes, and take the shortest of several measurements to filter out preemptions and
+        // interrupts.
+    constexpr int iterationCount = 256;
+    constexpr int repetitionCount = 5;
+    auto value = std::atomic<int>(0);
+    auto minDuration = std::chrono::steady_clock::duration::max();
+    for (int i = 0; i < repetitionCount; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        spin(value, iterationCount);
+        minDuration = std::min(minDuration, std::chrono::steady_clock::now() - start);
+    }
+    return std::max(std::chrono::duration<double, std::nano>(minDuration).count()/iterationCount, 0.1);
+}
+
+spin_calibration
+calibrate_spin_wait() noexcept
+{
+    auto result = spin_calibration{ };
+#if defined(UMWAIT_SUPPORTED) || defined(WFE_SUPPORTED)
+    result.haveMonitoredWait = detail::monitored_wait_supported();
+    auto startTime = std::chrono::steady_clock::now();
+    std::uint64_t startCounter = detail::monitored_wait_counter();
+#endif // defined(UMWAIT_SUPPORTED) || defined(WFE_SUPPORTED)
+    result.backoffIterationNanoseconds = detail::measure_spin_iteration(
+        [](std::atomic<int> const& a, int iterationCount)
+        {
+            [[maybe_unused]] bool changed = detail::spin_equal_exponential_backoff(a, 0, iterationCount);
+        });
+    result.pauseNanoseconds = detail::measure_spin_iteration(
+        [](std::atomic<int> const& a, int iterationCount)
+        {
+            [[maybe_unused]] bool changed = detail::spin_equal(a, 0, iterationCount);
+        });
+    result.backoffIterationCount = spin_calibration::iteration_count(spinDuration, result.backoffIterationNanoseconds);
+#if defined(UMWAIT_SUPPORTED) || defined(WFE_SUPPORTED)
+        // The measurements above take long enough to determine the counter frequency with sufficient accuracy.
+    std::uint64_t counterTicks = detail::monitored_wait_counter() - startCounter;
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime);
+    result.monitoredWaitTicksPerNanosecond = double(counterTicks)/std::max(elapsed.count(), 1.);
+#endif // defined(UMWAIT_SUPPORTED) || defined(WFE_SUPPORTED)
+    return result;
+}
+
+    // The spin loops are calibrated once per process, when the first thread squad is constructed.
+spin_calibration const&
+get_spin_calibration() noexcept
+{
+    static spin_calibration const calibration = detail::calibrate_spin_wait();
+    return calibration;
+}
+
+    // Spins for the given duration or until the value of `a` differs from `oldValue`. Uses a monitored wait if the processor
+    // supports it, so that the waiting thread does not take execution resources from its SMT sibling.
+template <typename T>
+bool
+spin_equal_for(std::atomic<T> const& a, T oldValue, std::chrono::nanoseconds duration) noexcept
+{
+    auto const& calibration = detail::get_spin_calibration();
+#if defined(UMWAIT_SUPPORTED) || defined(WFE_SUPPORTED)
+    if (calibration.haveMonitoredWait)
+    {
+        return detail::monitored_wait_equal(a, oldValue, calibration.monitored_wait_ticks(duration));
+    }
+#endif // defined(UMWAIT_SUPPORTED) || defined(WFE_SUPPORTED)
+    return detail::spin_equal(a, oldValue, calibration.pause_count(duration));
+}
+
+template <typename T>
+bool
+wait_equal_exponential_backoff(std::atomic<T> const& a, T oldValue) noexcept
+{
+    if (a.load(std::memory_order_relaxed) != oldValue) return true;
+    if (detail::spin_equal_exponential_backoff(a, oldValue, detail::get_spin_calibration().backoffIterationCount)) return true;
+    return detail::yield_equal(a, oldValue);
+}
+
 template <typename T>
 bool
 wait_equal_smt(std::atomic<T> const& a, T oldValue) noexcept
 {
     if (a.load(std::memory_order_relaxed) != oldValue) return true;
-    for (int i = 0; i < (1 << smtPauseCountExp); ++i)
+    if (detail::spin_equal_for(a, oldValue, smtSpinDuration)) return true;
+    return detail::yield_equal(a, oldValue);
+}
+
+    // Bounds of the spin duration for adaptive spin waiting. Spinning for longer than a blocked thread takes to wake up does not
+    // pay off, and the wake-up latency of a blocked thread is typically in the order of tens of microseconds.
+constexpr auto minAdaptiveSpinDuration = std::chrono::nanoseconds(500);
+constexpr auto maxAdaptiveSpinDuration = std::chrono::nanoseconds(50'000);
+constexpr auto initialAdaptiveSpinDuration = std::chrono::nanoseconds(4'000);
+
+    // Spin budget of a thread which adapts to the wait durations observed by the thread.
+struct adaptive_spin_state
+{
+    std::chrono::nanoseconds spinDuration = initialAdaptiveSpinDuration;
+
+    void
+    update(std::chrono::nanoseconds waitDuration, bool blocked) noexcept
     {
-        if (a.load(std::memory_order_relaxed) != oldValue) return true;
-        detail::pause();
+        if (!blocked)
+        {
+                // Let the spin duration approach twice the duration of a typical short wait.
+            spinDuration += (2*waitDuration - spinDuration)/8;
+        }
+        else if (waitDuration < 2*maxAdaptiveSpinDuration)
+        {
+                // The duration of a blocked wait includes the wake-up latency, which is assumed to be about as long as the
+                // maximal spin duration. The wait would thus likely have ended within the maximal spin duration, and spinning
+                // longer would have avoided blocking.
+            spinDuration *= 2;
+        }
+        else
+        {
+                // The thread was idle for long; spinning longer would only have wasted processor time.
+            spinDuration -= spinDuration/8;
+        }
+        spinDuration = std::clamp(spinDuration, minAdaptiveSpinDuration, maxAdaptiveSpinDuration);
     }
-    int lyieldCount = 1 << yieldCountExp;
-    for (int i = 0; i < lyieldCount; ++i)
+};
+
+template <typename T>
+void
+wait_adaptive(std::atomic<T>& a, T oldValue, adaptive_spin_state& spinState) noexcept
+{
+        // Waits which end right away tell us nothing about the wait durations, so we do not bother reading the clock.
+    if (a.load(std::memory_order_acquire) != oldValue) return;
+
+        // The clock is read only before and after waiting; the spin duration is converted to a calibrated number of pause
+        // iterations or counter ticks.
+    auto start = std::chrono::steady_clock::now();
+    bool blocked = !detail::spin_equal_for(a, oldValue, spinState.spinDuration);
+    if (!blocked)
     {
-        if (a.load(std::memory_order_relaxed) != oldValue) return true;
-        std::this_thread::yield();
+        [[maybe_unused]] auto _ = a.load(std::memory_order_acquire);
     }
-    return false;
+    else
+    {
+        a.wait(oldValue, std::memory_order_acquire);
+    }
+    spinState.update(std::chrono::steady_clock::now() - start, blocked);
 }
 
 enum class wait_mode
 {
     wait,
     spin_wait,
-    smt_spin_wait
+    smt_spin_wait,
+    adaptive_spin_wait
 };
 
 template <typename T>
@@ -378,6 +663,8 @@ wait(
     std::atomic<T>& a, T oldValue,
     wait_mode waitMode = wait_mode::spin_wait) noexcept
 {
+    gsl_Assert(waitMode != wait_mode::adaptive_spin_wait);  // requires spin state
+
     if ((waitMode == wait_mode::spin_wait && detail::wait_equal_exponential_backoff(a, oldValue)) ||
         (waitMode == wait_mode::smt_spin_wait && detail::wait_equal_smt(a, oldValue)))
     {
@@ -390,12 +677,79 @@ wait(
 }
 template <typename T>
 void
+wait(
+    std::atomic<T>& a, T oldValue,
+    wait_mode waitMode, adaptive_spin_state& spinState) noexcept
+{
+    if (waitMode == wait_mode::adaptive_spin_wait)
+    {
+        detail::wait_adaptive(a, oldValue, spinState);
+    }
+    else
+    {
+        detail::wait(a, oldValue, waitMode);
+    }
+}
+template <typename T>
+void
 wait(
     std::atomic<T>& a,
     wait_mode waitMode = wait_mode::spin_wait) noexcept
 {
     detail::wait(a, { }, waitMode);
 }
+template <typename T>
+void
+wait(
+    std::atomic<T>& a,
+    wait_mode waitMode, adaptive_spin_state& spinState) noexcept
+{
+    detail::wait(a, { }, waitMode, spinState);
+}
+
+    // Waits until the value of `a` differs from `oldValue`, blocking on the epoch counter `epoch` rather than on `a`. The
+    // notifying thread must change `a` before incrementing `epoch`.
+template <typename T>
+void
+wait_epoch(
+    std::atomic<T>& a, T oldValue,
+    std::atomic<std::uint32_t>& epoch) noexcept
+{
+    for (;;)
+    {
+            // If we miss the change of `a`, we read the epoch value before the increment, so the wait returns right away.
+        std::uint32_t currentEpoch = epoch.load(std::memory_order_acquire);
+        if (a.load(std::memory_order_acquire) != oldValue) return;
+        epoch.wait(currentEpoch, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+void
+wait_at_least(
+    std::atomic<T>& a, T minValue,
+    wait_mode waitMode = wait_mode::spin_wait) noexcept
+{
+    for (;;)
+    {
+        T value = a.load(std::memory_order_acquire);
+        if (value >= minValue) return;
+        detail::wait(a, value, waitMode);
+    }
+}
+template <typename T>
+void
+wait_at_least(
+    std::atomic<T>& a, T minValue,
+    wait_mode waitMode, adaptive_spin_state& spinState) noexcept
+{
+    for (;;)
+    {
+        T value = a.load(std::memory_order_acquire);
+        if (value >= minValue) return;
+        detail::wait(a, value, waitMode, spinState);
+    }
+}
 
 template <typename T>
 void
@@ -407,12 +761,19 @@ reset(
 }
 template <typename T>
 void
-set_and_notify(
+set(
     std::atomic<T>& a, T newValue) noexcept
 {
     T oldValue = a.load(std::memory_order_relaxed);
     gsl_Assert(oldValue != newValue);
     a.store(newValue, std::memory_order_release);
+}
+template <typename T>
+void
+set_and_notify(
+    std::atomic<T>& a, T newValue) noexcept
+{
+    detail::set(a, newValue);
     a.notify_one();
 }
 
@@ -549,6 +910,182 @@ get_hardware_thread_id(int threadIdx, int maxNumHardwareThreads, std::span<int c
 #endif // THREAD_PINNING_SUPPORTED
 
 
+#ifdef THREAD_PINNING_SUPPORTED
+static std::vector<int>
+compute_placement_mappings(thread_squad::placement_policy placement, int maxNumHardwareThreads)
+{
+    gsl_Expects(placement != thread_squad::placement_policy::none);
+
+    auto infos = detail::hardware_thread_infos();
+    auto hwThreads = std::vector<hardware_thread_info>(infos.begin(), infos.end());
+    auto numSelected = std::min(gsl::narrow_failfast<std::size_t>(maxNumHardwareThreads), hwThreads.size());
+
+    auto compactOrder = []
+    (hardware_thread_info const& lhs, hardware_thread_info const& rhs)
+    {
+        return std::tie(lhs.node, lhs.package, lhs.llc, lhs.core, lhs.smt_rank, lhs.id)
+             < std::tie(rhs.node, rhs.package, rhs.llc, rhs.core, rhs.smt_rank, rhs.id);
+    };
+    auto coresFirstOrder = []
+    (hardware_thread_info const& lhs, hardware_thread_info const& rhs)
+    {
+        return std::tie(lhs.smt_rank, lhs.node, lhs.package, lhs.core, lhs.id)
+             < std::tie(rhs.smt_rank, rhs.node, rhs.package, rhs.core, rhs.id);
+    };
+
+        // Select the hardware threads to use.
+    auto selected = std::vector<hardware_thread_info>{ };
+    switch (placement)
+    {
+    case thread_squad::placement_policy::none:
+        break;
+    case thread_squad::placement_policy::compact:
+        std::sort(hwThreads.begin(), hwThreads.end(), compactOrder);
+        selected.assign(hwThreads.begin(), hwThreads.begin() + std::ptrdiff_t(numSelected));
+        break;
+    case thread_squad::placement_policy::cores_first:
+        std::sort(hwThreads.begin(), hwThreads.end(), coresFirstOrder);
+        selected.assign(hwThreads.begin(), hwThreads.begin() + std::ptrdiff_t(numSelected));
+        break;
+    case thread_squad::placement_policy::scatter:
+        {
+                // Pick hardware threads from all nodes in a round-robin fashion; within every node, prefer distinct cores.
+            std::sort(hwThreads.begin(), hwThreads.end(), coresFirstOrder);
+            int numNodes = 0;
+            for (auto const& hwThread : hwThreads)
+            {
+                numNodes = std::max(numNodes, hwThread.node + 1);
+            }
+            auto nodeHwThreads = std::vector<std::vector<hardware_thread_info>>(gsl::narrow_failfast<std::size_t>(numNodes));
+            for (auto const& hwThread : hwThreads)
+            {
+                nodeHwThreads[hwThread.node].push_back(hwThread);
+            }
+            for (std::size_t i = 0; selected.size() < numSelected; ++i)
+            {
+                for (auto const& node : nodeHwThreads)
+                {
+                    if (i < node.size() && selected.size() < numSelected)
+                    {
+                        selected.push_back(node[i]);
+                    }
+                }
+            }
+        }
+        break;
+    }
+
+        // Order the selected hardware threads by node, and place hardware threads of the same cache domain and of the same core
+        // next to each other, such that subtrees of the synchronization tree tend to share a node, a cache, and a core.
+    std::sort(selected.begin(), selected.end(), compactOrder);
+
+    auto result = std::vector<int>(selected.size());
+    std::transform(selected.begin(), selected.end(), result.begin(),
+        [](hardware_thread_info const& hwThread)
+        {
+            return hwThread.id;
+        });
+    return result;
+}
+
+    // Returns the length of the runs of consecutive thread indices with equal key, or 0 if the runs differ in length. The last
+    // run may be shorter than the others.
+template <typename KeyT>
+static int
+uniform_run_length(std::span<KeyT const> keys) noexcept
+{
+    int runLength = 0;
+    int first = 0;
+    for (int i = 1; i <= std::ssize(keys); ++i)
+    {
+        if (i == std::ssize(keys) || keys[i] != keys[first])
+        {
+            if (runLength == 0)
+            {
+                runLength = i - first;
+            }
+            else if (i - first > runLength || (i - first < runLength && i != std::ssize(keys)))
+            {
+                return 0;
+            }
+            first = i;
+        }
+    }
+    return runLength;
+}
+#endif // THREAD_PINNING_SUPPORTED
+
+    // Appends strides of tree levels which subdivide subtrees of the last stride into subtrees of the given group size, with
+    // at most `treeBreadth` subtrees per level.
+static void
+append_tree_strides(std::vector<int>& strides, int groupSize, int treeBreadth)
+{
+    int stride = strides.back();
+    while (stride > groupSize)
+    {
+        int numGroups = (stride + (groupSize - 1))/groupSize;
+        stride = (numGroups + (treeBreadth - 1))/treeBreadth*groupSize;
+        strides.push_back(stride);
+    }
+}
+
+    // Computes the strides of the levels of the synchronization tree, i.e. the number of threads in the subtrees of every
+    // level, starting with `p.num_threads` and ending with 1.
+static std::vector<int>
+compute_tree_strides(thread_squad::params const& p)
+{
+    auto strides = std::vector<int>{ p.num_threads };
+    if (p.topology == thread_squad::tree_topology::flat)
+    {
+        detail::append_tree_strides(strides, 1, std::max(p.num_threads, 2));
+        return strides;
+    }
+#ifdef THREAD_PINNING_SUPPORTED
+    if (p.topology == thread_squad::tree_topology::hardware && p.pin_to_hardware_threads)
+    {
+        auto infos = detail::hardware_thread_infos();
+        auto threadInfos = std::vector<hardware_thread_info>(gsl::narrow_failfast<std::size_t>(p.num_threads));
+        for (int i = 0; i < p.num_threads; ++i)
+        {
+            int id = gsl::narrow_failfast<int>(detail::get_hardware_thread_id(
+                i, p.max_num_hardware_threads, p.hardware_thread_mappings));
+            auto it = std::lower_bound(infos.begin(), infos.end(), id,
+                [](hardware_thread_info const& info, int _id) { return info.id < _id; });
+
+                // If the topology of the hardware thread is unknown, treat it as a core of its own.
+            threadInfos[i] = it != infos.end() && it->id == id
+                ? *it
+                : hardware_thread_info{ .id = id, .node = 0, .package = 0, .core = id, .llc = -1, .smt_rank = 0 };
+        }
+
+            // Add levels for packages, cache domains, and cores, skipping every level whose groups of threads are not
+            // contiguous and of uniform size.
+        auto packageKeys = std::vector<std::tuple<int>>(threadInfos.size());
+        auto llcKeys = std::vector<std::tuple<int, int>>(threadInfos.size());
+        auto coreKeys = std::vector<std::tuple<int, int, int>>(threadInfos.size());
+        for (std::size_t i = 0; i < threadInfos.size(); ++i)
+        {
+            auto const& info = threadInfos[i];
+            packageKeys[i] = { info.package };
+            llcKeys[i] = { info.package, info.llc };
+            coreKeys[i] = { info.package, info.llc, info.core };
+        }
+        for (int groupSize : { detail::uniform_run_length<std::tuple<int>>(packageKeys),
+                               detail::uniform_run_length<std::tuple<int, int>>(llcKeys),
+                               detail::uniform_run_length<std::tuple<int, int, int>>(coreKeys) })
+        {
+            if (groupSize != 0 && groupSize < strides.back())
+            {
+                detail::append_tree_strides(strides, groupSize, p.tree_breadth);
+            }
+        }
+    }
+#endif // THREAD_PINNING_SUPPORTED
+    detail::append_tree_strides(strides, 1, p.tree_breadth);
+    return strides;
+}
+
+
 #if defined(_WIN32)
 static unsigned __stdcall
 thread_squad_thread_func(void* data);
@@ -571,7 +1108,8 @@ public:
             // structure
         thread_squad_impl& threadSquad_;
         int threadIdx_ = -1;
-        int numSubthreads_ = -1;
+        int numSubthreads_ = -1;  // stride of the tree level at which the thread heads its subtree
+        int subtreeLast_ = -1;    // one past the last thread index of the subtree; the subtree of the last sibling may be truncated
         int pass_ = 0;
 
             // resources
@@ -583,6 +1121,15 @@ public:
         std::atomic<int> signalCollecting_;     // set to 1 by worker thread, set to 0 by controlling thread
         std::atomic<int> signalBroadcasting_;   // set to 1 by controlling thread, set to 0 by worker thread
         void* syncData_;  // synchronization data made accessible to the superordinate thread between collection and distribution
+        adaptive_spin_state taskWaitSpinState_;  // spin budget for waiting on a new task with `wait_policy::adaptive_spin`
+
+            // work-stealing data; kept on a separate cache line because it is accessed by other threads during a task
+        alignas(destructive_interference_size) std::atomic<std::uint64_t> chunks_;  // range of chunk indices [first, last), packed as `(last << 32) | first`
+
+            // scratch memory for tasks; reset after every task
+        alignas(destructive_interference_size) patton::arena arena_;
+        void* arenaData_ = nullptr;
+        std::size_t arenaSize_ = 0;
 
         int
         num_threads_for_task() const noexcept
@@ -599,9 +1146,35 @@ public:
               signalTaskProcessed_(0),
               signalCollecting_(0),
               signalBroadcasting_(0),
-              syncData_(nullptr)
+              syncData_(nullptr),
+              chunks_(0)
         {
         }
+        ~thread_data()
+        {
+            if (arenaData_ != nullptr)
+            {
+                detail::page_free(arenaData_, arenaSize_);
+            }
+        }
+
+        void
+        allocate_arena(std::size_t size)
+        {
+            gsl_Expects(arenaData_ == nullptr);
+
+                // `page_alloc()` does not touch the pages if `size` is a multiple of the page size, so the pages are placed
+                // on the NUMA node of the thread which first uses them.
+            arenaData_ = detail::page_alloc(size);
+            arenaSize_ = size;
+            arena_ = patton::arena(arenaData_, size);
+        }
+
+        patton::arena&
+        arena() noexcept
+        {
+            return arena_;
+        }
 
         bool
         is_initial_pass() const noexcept
@@ -658,22 +1231,38 @@ public:
         thread_squad_task&
         task_wait() noexcept
         {
+            if (threadIdx_ == 0)
+            {
+                    // Thread 0 retrieves tasks from the task queue.
+                return threadSquad_.dequeue_task();
+            }
+
             THREAD_SQUAD_DBG("patton thread squad, thread %d: waiting for new task\n", threadIdx_);
             //detail::wait_and_reset(signalTaskAvailable_, threadSquad_.waitMode_);
-            detail::wait(signalTaskAvailable_, threadSquad_.waitMode_);
+            if (threadSquad_.broadcastWake_)
+            {
+                detail::wait_epoch(signalTaskAvailable_, 0, threadSquad_.taskEpoch_);
+            }
+            else
+            {
+                detail::wait(signalTaskAvailable_, threadSquad_.taskWaitMode_, taskWaitSpinState_);
+            }
             THREAD_SQUAD_DBG("patton thread squad, thread %d: processing task\n", threadIdx_);
             gsl_Assert(threadSquad_.task_ != nullptr);
             return *threadSquad_.task_;
         }
 
         void
-        task_run(thread_squad_task& task) const noexcept
+        task_run(thread_squad_task& task) noexcept
         {
             if (threadIdx_ < task.params.concurrency)
             {
                     // Like the parallel overloads of the standard algorithms, we terminate (implicitly) if an exception is thrown
                     // by a task because the semantics of exceptions in multiplexed actions are unclear.
                 task.execute(threadSquad_, threadIdx_, task.params.concurrency);
+
+                    // Release all scratch allocations made by the task.
+                arena_.reset();
             }
         }
 
@@ -681,6 +1270,11 @@ public:
         task_signal_completion() noexcept
         {
             THREAD_SQUAD_DBG("patton thread squad, thread %d: signaling task completion\n", threadIdx_);
+            if (threadIdx_ == 0)
+            {
+                threadSquad_.signal_task_dequeued_completion();
+                return;
+            }
             detail::reset(signalTaskAvailable_);
             detail::set_and_notify(signalTaskProcessed_);
         }
@@ -702,16 +1296,36 @@ public:
 
 
 private:
-    static constexpr int treeBreadth = 8;
+        // strides of the levels of the synchronization tree, cf. `compute_tree_strides()`
+    std::vector<int> treeStrides_;
 
         // synchronization data
     aligned_buffer<thread_data, page_alignment> threadData_;
     wait_mode waitMode_;
     wait_mode smtWaitMode_;
+    wait_mode taskWaitMode_;  // for waiting on a new task
+    bool broadcastWake_;
 
-        // task-specific data
+        // incremented by thread 0 after signaling a new task to all other threads if `broadcastWake_` is set; kept on a separate
+        // cache line because it is read by all threads
+    alignas(destructive_interference_size) std::atomic<std::uint32_t> taskEpoch_{ 0 };
+
+        // task-specific data; written by thread 0, read by all other threads
     detail::thread_squad_task* task_;
 
+        // task queue; written by the controlling thread, read by thread 0
+    static constexpr std::uint64_t taskQueueCapacity = 8;
+    std::array<thread_squad_task*, taskQueueCapacity> taskQueue_{ };
+    alignas(destructive_interference_size) std::atomic<std::uint64_t> numSubmittedTasks_{ 0 };
+
+        // task queue state owned by thread 0
+    alignas(destructive_interference_size) std::atomic<std::uint64_t> numCompletedTasks_{ 0 };
+    std::uint64_t numDequeuedTasks_ = 0;
+
+        // task queue state owned by the controlling thread
+    alignas(destructive_interference_size) std::array<thread_squad_task_deleter, taskQueueCapacity> taskDeleters_{ };
+    std::uint64_t numReleasedTasks_ = 0;
+
 
     //int
     //num_threads_for_task() const noexcept
@@ -721,10 +1335,12 @@ private:
     //        : task_->params.concurrency;
     //}
 
-    static int
-    next_substride(int stride) noexcept
+    int
+    next_substride(int stride) const noexcept
     {
-        return (stride + (treeBreadth - 1)) / treeBreadth;
+        auto it = std::find(treeStrides_.begin(), treeStrides_.end(), stride);
+        gsl_Assert(it != treeStrides_.end());
+        return std::next(it) != treeStrides_.end() ? *std::next(it) : 1;
     }
 
     void
@@ -739,6 +1355,7 @@ private:
             }
         }
         threadData_[first].numSubthreads_ = stride;
+        threadData_[first].subtreeLast_ = last;
     }
 
     template <typename F>
@@ -746,7 +1363,7 @@ private:
     to_subthreads(int callingThreadIdx, int _concurrency, F func) noexcept
     {
         int stride = threadData_[callingThreadIdx].numSubthreads_;
-        int last = std::min(callingThreadIdx + stride, _concurrency);
+        int last = std::min(threadData_[callingThreadIdx].subtreeLast_, _concurrency);
         while (stride != 1)
         {
             int substride = next_substride(stride);
@@ -778,7 +1395,109 @@ private:
     from_subthreads(int callingThreadIdx, int _concurrency, F func) noexcept
     {
         int stride = threadData_[callingThreadIdx].numSubthreads_;
-        from_subthreads_impl(callingThreadIdx, std::min(callingThreadIdx + stride, _concurrency), stride, func);
+        int last = std::min(threadData_[callingThreadIdx].subtreeLast_, _concurrency);
+        from_subthreads_impl(callingThreadIdx, last, stride, func);
+    }
+
+    static constexpr std::uint64_t
+    pack_chunks(std::uint32_t first, std::uint32_t last) noexcept
+    {
+        return (std::uint64_t(last) << 32) | first;
+    }
+    static constexpr std::uint32_t
+    first_chunk(std::uint64_t chunks) noexcept
+    {
+        return std::uint32_t(chunks);
+    }
+    static constexpr std::uint32_t
+    last_chunk(std::uint64_t chunks) noexcept
+    {
+        return std::uint32_t(chunks >> 32);
+    }
+
+    bool
+    pop_chunk(int threadIdx, std::uint32_t& chunk) noexcept
+    {
+            // Chunk indices do not guard any data, hence relaxed memory ordering suffices.
+        auto& chunks = threadData_[threadIdx].chunks_;
+        std::uint64_t current = chunks.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            std::uint32_t first = first_chunk(current);
+            std::uint32_t last = last_chunk(current);
+            if (first >= last) return false;
+            if (chunks.compare_exchange_weak(current, pack_chunks(first + 1, last), std::memory_order_relaxed))
+            {
+                chunk = first;
+                return true;
+            }
+        }
+    }
+
+    bool
+    steal_chunks(int threadIdx, int victimThreadIdx, std::uint32_t& chunk) noexcept
+    {
+            // Steal the upper half of the victim's chunks.
+        auto& victimChunks = threadData_[victimThreadIdx].chunks_;
+        std::uint64_t current = victimChunks.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            std::uint32_t first = first_chunk(current);
+            std::uint32_t last = last_chunk(current);
+            if (first >= last) return false;
+            std::uint32_t mid = last - (last - first + 1)/2;
+            if (victimChunks.compare_exchange_weak(current, pack_chunks(first, mid), std::memory_order_relaxed))
+            {
+                    // Process the first stolen chunk right away and make the remaining ones available to other thieves.
+                    // Our own range is empty, so other threads do not modify it, and we can simply overwrite it. The stolen
+                    // chunks were never part of our range before, so thieves holding a stale value cannot succeed in
+                    // exchanging it.
+                chunk = mid;
+                threadData_[threadIdx].chunks_.store(pack_chunks(mid + 1, last), std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    template <typename F>
+    void
+    for_each_nearby_thread(int threadIdx, int _concurrency, F func) const noexcept
+    {
+            // Enumerate the threads in the subtrees enclosing the given thread, starting with the innermost subtree.
+        constexpr int maxNumLevels = 32;
+        int firsts[maxNumLevels];
+        int lasts[maxNumLevels];
+        int numLevels = 0;
+        int first = 0;
+        int last = std::min(numThreads, _concurrency);
+        int stride = numThreads;
+        while (stride != 1)
+        {
+            gsl_Assert(numLevels < maxNumLevels);
+            firsts[numLevels] = first;
+            lasts[numLevels] = last;
+            ++numLevels;
+            int substride = next_substride(stride);
+            first += (threadIdx - first)/substride*substride;
+            last = std::min(first + substride, last);
+            stride = substride;
+        }
+        int innerFirst = threadIdx;
+        int innerLast = threadIdx + 1;
+        for (int level = numLevels - 1; level >= 0; --level)
+        {
+            for (int i = firsts[level]; i < lasts[level]; ++i)
+            {
+                if (i == innerFirst)
+                {
+                    i = innerLast - 1;
+                    continue;
+                }
+                if (func(i)) return;
+            }
+            innerFirst = firsts[level];
+            innerLast = lasts[level];
+        }
     }
 
     void
@@ -802,14 +1521,29 @@ private:
 public:
     thread_squad_impl(thread_squad::params const& params)
         : thread_squad_impl_base{ params.num_threads },
+          treeStrides_(detail::compute_tree_strides(params)),
           threadData_(gsl::narrow_failfast<std::size_t>(params.num_threads), std::in_place, *this),
-          waitMode_(params.spin_wait ? wait_mode::spin_wait : wait_mode::wait),
-          smtWaitMode_(params.spin_wait ? wait_mode::smt_spin_wait : wait_mode::wait)
+          waitMode_(params.spin_wait || params.wait != thread_squad::wait_policy::block ? wait_mode::spin_wait : wait_mode::wait),
+          smtWaitMode_(params.spin_wait || params.wait != thread_squad::wait_policy::block ? wait_mode::smt_spin_wait : wait_mode::wait),
+          taskWaitMode_(params.wait == thread_squad::wait_policy::adaptive_spin ? wait_mode::adaptive_spin_wait : waitMode_),
+          broadcastWake_(params.broadcast_wake)
     {
+            // Calibrate the spin loops before any thread waits.
+        [[maybe_unused]] auto const& spinCalibration = detail::get_spin_calibration();
+
         for (int i = 0; i < numThreads; ++i)
         {
             threadData_[i].threadIdx_ = i;
         }
+        if (params.arena_size != 0)
+        {
+            auto arenaSizeR = detail::try_ceili(params.arena_size, hardware_page_size());
+            if (arenaSizeR.ec != std::errc{ }) throw std::bad_alloc{ };
+            for (int i = 0; i < numThreads; ++i)
+            {
+                threadData_[i].allocate_arena(arenaSizeR.value);
+            }
+        }
 #ifdef THREAD_PINNING_SUPPORTED
         if (params.pin_to_hardware_threads)
         {
@@ -896,9 +1630,37 @@ public:
         threadData_[targetThreadIdx].osThread_.join();
     }
 
+    void
+    notify_all_threads(int _concurrency) noexcept
+    {
+            // Signal the new task to all threads, then wake them with a single notification. A thread which observes its task
+            // flag may start running before it is woken and then wait for its subordinate threads, so all completion flags must
+            // be reset before any task flag is set.
+        THREAD_SQUAD_DBG("patton thread squad, thread 0: broadcast task to %d threads\n", _concurrency);
+        for (int i = 1; i < _concurrency; ++i)
+        {
+            detail::reset(threadData_[i].signalTaskProcessed_);
+        }
+        for (int i = 1; i < _concurrency; ++i)
+        {
+            detail::set(threadData_[i].signalTaskAvailable_, 1);
+        }
+        taskEpoch_.fetch_add(1, std::memory_order_release);
+        taskEpoch_.notify_all();
+    }
+
     void
     notify_subthreads(int callingThreadIdx, int _concurrency) noexcept
     {
+        if (broadcastWake_)
+        {
+                // Thread 0 notifies all other threads at once.
+            if (callingThreadIdx == 0)
+            {
+                notify_all_threads(_concurrency);
+            }
+            return;
+        }
         to_subthreads(
             callingThreadIdx, _concurrency,
             [this]
@@ -945,6 +1707,23 @@ public:
             });
     }
 
+    void
+    signal_collected(task_context_synchronizer& synchronizer, int callingThreadIdx) noexcept
+    {
+            // Make the synchronizer data available for the duration of the synchronization.
+        threadData_[callingThreadIdx].syncData_ = synchronizer.sync_data();
+        detail::reset(threadData_[callingThreadIdx].signalBroadcasting_);
+        detail::set_and_notify(threadData_[callingThreadIdx].signalCollecting_);
+    }
+
+    void
+    wait_for_broadcast(int callingThreadIdx) noexcept
+    {
+        //detail::wait_and_reset(threadData_[callingThreadIdx].signalBroadcasting_, waitMode_);
+        detail::wait(threadData_[callingThreadIdx].signalBroadcasting_, waitMode_);
+        threadData_[callingThreadIdx].syncData_ = nullptr;
+    }
+
     void
     synchronize_collect(task_context_synchronizer& synchronizer, int callingThreadIdx) noexcept
     {
@@ -958,15 +1737,10 @@ public:
             });
 
             // If there is a superordinate thread, signal availability and wait.
-            // Make the synchronizer data available for the duration of the synchronization.
         if (callingThreadIdx > 0)
         {
-            threadData_[callingThreadIdx].syncData_ = synchronizer.sync_data();
-            detail::reset(threadData_[callingThreadIdx].signalBroadcasting_);
-            detail::set_and_notify(threadData_[callingThreadIdx].signalCollecting_);
-            //detail::wait_and_reset(threadData_[callingThreadIdx].signalBroadcasting_, waitMode_);
-            detail::wait(threadData_[callingThreadIdx].signalBroadcasting_, waitMode_);
-            threadData_[callingThreadIdx].syncData_ = nullptr;
+            signal_collected(synchronizer, callingThreadIdx);
+            wait_for_broadcast(callingThreadIdx);
         }
     }
     void
@@ -982,17 +1756,104 @@ public:
             });
     }
 
+    bool
+    synchronize_arrive(int callingThreadIdx, int& numCollected) noexcept
+    {
+            // Collect from as many subordinate threads as have already arrived, but do not wait for the others.
+        auto synchronizer = task_context_synchronizer{ };
+        bool allArrived = true;
+        numCollected = 0;
+        from_subthreads(
+            callingThreadIdx, task_->params.concurrency,
+            [this, &allArrived, &numCollected]
+            ([[maybe_unused]] int callingThreadIdx, int targetThreadIdx)
+            {
+                if (allArrived && threadData_[targetThreadIdx].signalCollecting_.load(std::memory_order_acquire) != 0)
+                {
+                    ++numCollected;
+                }
+                else
+                {
+                    allArrived = false;
+                }
+            });
+
+            // If all subordinate threads have arrived, we can signal arrival to the superordinate thread right away.
+        if (allArrived && callingThreadIdx > 0)
+        {
+            signal_collected(synchronizer, callingThreadIdx);
+        }
+        return allArrived;
+    }
     void
-    store_task(detail::thread_squad_task& task)
-    noexcept  // We cannot really handle exceptions here.
+    synchronize_wait(int callingThreadIdx, int numCollected, bool arrived) noexcept
     {
-        task_ = &task;
+        auto synchronizer = task_context_synchronizer{ };
+        if (!arrived)
+        {
+                // Collect from the subordinate threads which had not arrived yet.
+            int i = 0;
+            from_subthreads(
+                callingThreadIdx, task_->params.concurrency,
+                [this, &synchronizer, &i, numCollected]
+                (int callingThreadIdx, int targetThreadIdx)
+                {
+                    if (i++ >= numCollected)
+                    {
+                        collect_from_thread(synchronizer, callingThreadIdx, targetThreadIdx);
+                    }
+                });
+            if (callingThreadIdx > 0)
+            {
+                signal_collected(synchronizer, callingThreadIdx);
+            }
+        }
+        if (callingThreadIdx > 0)
+        {
+            wait_for_broadcast(callingThreadIdx);
+        }
+        synchronize_broadcast(synchronizer, callingThreadIdx);
     }
 
     void
-    release_task()
+    assign_chunks(std::uint32_t numChunks, int _concurrency) noexcept
+    {
+            // Distribute chunks evenly among the participating threads; the first threads get an extra chunk if the chunks
+            // cannot be distributed evenly.
+        std::uint32_t numRunningThreads = static_cast<std::uint32_t>(_concurrency);
+        std::uint32_t chunksPerThread = numChunks/numRunningThreads;
+        std::uint32_t remainder = numChunks % numRunningThreads;
+        std::uint32_t first = 0;
+        for (std::uint32_t i = 0; i < numRunningThreads; ++i)
+        {
+            std::uint32_t last = first + chunksPerThread + (i < remainder ? 1 : 0);
+            threadData_[i].chunks_.store(pack_chunks(first, last), std::memory_order_relaxed);
+            first = last;
+        }
+    }
+
+    patton::arena&
+    arena(int threadIdx) noexcept
     {
-        task_ = nullptr;
+        return threadData_[threadIdx].arena();
+    }
+
+    bool
+    next_chunk(int threadIdx, std::uint32_t& chunk) noexcept
+    {
+        if (pop_chunk(threadIdx, chunk)) return true;
+
+            // If we ran out of chunks, try to steal some from other threads, preferring nearby threads. Stolen chunks
+            // which are in transit may be missed here, but they will be processed by the thief.
+        bool stolen = false;
+        for_each_nearby_thread(threadIdx, task_->params.concurrency,
+            [this, threadIdx, &chunk, &stolen]
+            (int victimThreadIdx)
+            {
+                stolen = steal_chunks(threadIdx, victimThreadIdx, chunk);
+                return stolen;
+            });
+        return stolen;
     }
 
     void* thread_context_for(int threadIdx)
@@ -1000,14 +1861,92 @@ public:
         return &threadData_[threadIdx];
     }
 
+    thread_squad_task&
+    dequeue_task() noexcept
+    {
+            // The current task remains dequeued until its completion is signaled.
+        if (numDequeuedTasks_ == numCompletedTasks_.load(std::memory_order_relaxed))
+        {
+            THREAD_SQUAD_DBG("patton thread squad, thread 0: waiting for new task\n");
+            detail::wait_at_least(numSubmittedTasks_, numDequeuedTasks_ + 1, taskWaitMode_, threadData_[0].taskWaitSpinState_);
+            THREAD_SQUAD_DBG("patton thread squad, thread 0: processing task\n");
+            task_ = taskQueue_[numDequeuedTasks_ % taskQueueCapacity];
+            ++numDequeuedTasks_;
+        }
+        return *task_;
+    }
+
+    void
+    signal_task_dequeued_completion() noexcept
+    {
+        numCompletedTasks_.store(numDequeuedTasks_, std::memory_order_release);
+        numCompletedTasks_.notify_one();
+    }
+
+    void
+    release_tasks(std::uint64_t sequenceNumber) noexcept
+    {
+            // Delete owned tasks and join the threads if a join was requested.
+        for (; numReleasedTasks_ < sequenceNumber; ++numReleasedTasks_)
+        {
+            std::size_t slot = numReleasedTasks_ % taskQueueCapacity;
+            thread_squad_task* task = taskQueue_[slot];
+            bool joinRequested = task->params.join_requested;
+            if (taskDeleters_[slot] != nullptr)
+            {
+                taskDeleters_[slot](task);
+            }
+            if (joinRequested)
+            {
+                //join_all_threads();
+                join_thread(-1, 0);
+            }
+        }
+    }
+
+    std::uint64_t
+    submit(detail::thread_squad_task& task, thread_squad_task_deleter deleter) noexcept;
+
+    void
+    wait_for_completion(std::uint64_t sequenceNumber) noexcept
+    {
+        THREAD_SQUAD_DBG("patton thread squad, thread -1: waiting for task %d to complete\n", int(sequenceNumber));
+        detail::wait_at_least(numCompletedTasks_, sequenceNumber, smtWaitMode_);
+        release_tasks(sequenceNumber);
+    }
+
+    bool
+    try_wait_for_completion(std::uint64_t sequenceNumber) noexcept
+    {
+        if (numCompletedTasks_.load(std::memory_order_acquire) < sequenceNumber)
+        {
+            return false;
+        }
+        release_tasks(sequenceNumber);
+        return true;
+    }
+
     void
-    run(detail::thread_squad_task& task) noexcept;
+    wait_for_all_tasks() noexcept
+    {
+        wait_for_completion(numSubmittedTasks_.load(std::memory_order_relaxed));
+    }
+
+    void
+    run(detail::thread_squad_task& task) noexcept
+    {
+        wait_for_completion(submit(task, nullptr));
+    }
 };
 
 static void
 run_thread(thread_squad_impl::thread_data& threadData)
 {
     THREAD_SQUAD_DBG("patton thread squad, thread %d: starting\n", threadData.thread_idx());
+
+        // Subthreads read the current task when they are notified, so thread 0 must retrieve its first task from the task
+        // queue before forking them. Waiting for a task is idempotent until its completion is signaled.
+    [[maybe_unused]] auto& firstTask = threadData.task_wait();
     threadData.notify_and_fork_subthreads();
 
     bool joinRequested;
@@ -1049,48 +1988,56 @@ run_thread(thread_squad_impl::thread_data& threadData)
 //
 
 
-void
-thread_squad_impl::run(detail::thread_squad_task& task)
+std::uint64_t
+thread_squad_impl::submit(detail::thread_squad_task& task, thread_squad_task_deleter deleter)
 noexcept  // We cannot really handle exceptions here.
 {
-    bool haveWork = (task.params.concurrency != 0) || (task.params.join_requested && have_thread_handle());
+    std::uint64_t numSubmittedTasks = numSubmittedTasks_.load(std::memory_order_relaxed);
 
-    if (haveWork)
+    bool haveWork = (task.params.concurrency != 0) || (task.params.join_requested && have_thread_handle());
+    if (!haveWork)
     {
-        if (!have_thread_handle())
+            // The task is complete as soon as all previously submitted tasks are complete.
+        if (deleter != nullptr)
         {
-            THREAD_SQUAD_DBG("patton thread squad: setting up\n");
-        }
-        if (task.params.join_requested)
-        {
-            THREAD_SQUAD_DBG("patton thread squad: tearing down\n");
+            deleter(&task);
         }
+        return numSubmittedTasks;
+    }
 
-        // We can either use global thread management (`fork_all_threads()` and `join_all_threads()`) or hierarchical thread management (`fork_thread(-1, 0)` and `join_thread(-1, 0)`),
-        // but we cannot mix them. Otherwise, thread handles are created and joined by different threads, which leads to ordering issues without explicit synchronization.
-
-        store_task(task);
-        //if (have_thread_handle())
-        //{
-        //    notify_thread(-1, 0);
-        //}
-        //else
-        //{
-        //    fork_all_threads();
-        //}
-        notify_thread(-1, 0);
-        if (!have_thread_handle())
-        {
-            fork_thread(-1, 0);
-        }
-        wait_for_thread(-1, 0, smtWaitMode_);
-        if (task.params.join_requested)
-        {
-            //join_all_threads();
-            join_thread(-1, 0);
-        }
-        release_task();
+    if (!have_thread_handle())
+    {
+        THREAD_SQUAD_DBG("patton thread squad: setting up\n");
+    }
+    if (task.params.join_requested)
+    {
+        THREAD_SQUAD_DBG("patton thread squad: tearing down\n");
+    }
+
+        // If the task queue is full, wait until thread 0 has completed the task in the slot we are about to reuse.
+    if (numSubmittedTasks >= taskQueueCapacity)
+    {
+        wait_for_completion(numSubmittedTasks - taskQueueCapacity + 1);
+    }
+    std::size_t slot = numSubmittedTasks % taskQueueCapacity;
+    taskQueue_[slot] = &task;
+    taskDeleters_[slot] = deleter;
+    THREAD_SQUAD_DBG("patton thread squad, thread -1: submit task %d\n", int(numSubmittedTasks + 1));
+    numSubmittedTasks_.store(numSubmittedTasks + 1, std::memory_order_release);
+    numSubmittedTasks_.notify_one();
+
+    // We can either use global thread management (`fork_all_threads()` and `join_all_threads()`) or hierarchical thread management (`fork_thread(-1, 0)` and `join_thread(-1, 0)`),
+    // but we cannot mix them. Otherwise, thread handles are created and joined by different threads, which leads to ordering issues without explicit synchronization.
+
+    //if (!have_thread_handle())
+    //{
+    //    fork_all_threads();
+    //}
+    if (!have_thread_handle())
+    {
+        fork_thread(-1, 0);
     }
+    return numSubmittedTasks + 1;
 }
 
 #if defined(_WIN32)
@@ -1204,6 +2151,35 @@ thread_squad::task_context::broadcast(detail::task_context_synchronizer& synchro
     auto& impl = static_cast<detail::thread_squad_impl&>(impl_);
     impl.synchronize_broadcast(synchronizer, threadIdx_);
 }
+thread_squad::task_context::arrival_token
+thread_squad::task_context::arrive() noexcept
+{
+    auto& impl = static_cast<detail::thread_squad_impl&>(impl_);
+    int numCollected;
+    bool arrived = impl.synchronize_arrive(threadIdx_, numCollected);
+    return arrival_token(numCollected, arrived);
+}
+void
+thread_squad::task_context::wait(arrival_token&& token) noexcept
+{
+    gsl_Expects(token.valid_);
+
+    auto& impl = static_cast<detail::thread_squad_impl&>(impl_);
+    impl.synchronize_wait(threadIdx_, token.numCollected_, token.arrived_);
+    token.valid_ = false;
+}
+patton::arena&
+thread_squad::task_context::arena() const noexcept
+{
+    auto& impl = static_cast<detail::thread_squad_impl&>(impl_);
+    return impl.arena(threadIdx_);
+}
+bool
+thread_squad::task_context::next_chunk(std::uint32_t& chunk) noexcept
+{
+    auto& impl = static_cast<detail::thread_squad_impl&>(impl_);
+    return impl.next_chunk(threadIdx_, chunk);
+}
 
 
 detail::thread_squad_handle
@@ -1233,9 +2209,93 @@ thread_squad::create(thread_squad::params p)
     }
 #endif // !THREAD_PINNING_SUPPORTED
 
+        // Compute the hardware thread mappings for the placement policy; the mappings need to live only until the thread
+        // squad has been constructed.
+    auto placementMappings = std::vector<int>{ };
+#ifdef THREAD_PINNING_SUPPORTED
+    if (p.pin_to_hardware_threads && p.placement != placement_policy::none)
+    {
+        placementMappings = detail::compute_placement_mappings(p.placement, p.max_num_hardware_threads);
+        p.hardware_thread_mappings = placementMappings;
+        p.max_num_hardware_threads = gsl::narrow_failfast<int>(placementMappings.size());
+    }
+#endif // THREAD_PINNING_SUPPORTED
+
     return detail::thread_squad_handle(new detail::thread_squad_impl(p));
 }
 
+void
+thread_squad::completion_handle::wait() noexcept
+{
+    if (impl_ != nullptr)
+    {
+        auto impl = static_cast<detail::thread_squad_impl*>(std::exchange(impl_, nullptr));
+        impl->wait_for_completion(sequenceNumber_);
+    }
+}
+
+bool
+thread_squad::completion_handle::try_wait() noexcept
+{
+    if (impl_ != nullptr)
+    {
+        auto impl = static_cast<detail::thread_squad_impl*>(impl_);
+        if (!impl->try_wait_for_completion(sequenceNumber_))
+        {
+            return false;
+        }
+        impl_ = nullptr;
+    }
+    return true;
+}
+
+bool
+thread_squad::completion_handle::do_wait_for(std::chrono::nanoseconds timeout) noexcept
+{
+        // Poll for completion, yielding at first and then sleeping for exponentially growing intervals.
+    constexpr int numYields = 16;
+    constexpr auto maxSleepDuration = std::chrono::nanoseconds(std::chrono::milliseconds(1));
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto sleepDuration = std::chrono::nanoseconds(std::chrono::microseconds(10));
+    for (int i = 0; ; ++i)
+    {
+        if (try_wait())
+        {
+            return true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+        if (i < numYields)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::min(sleepDuration, std::chrono::nanoseconds(deadline - now)));
+            sleepDuration = std::min(2*sleepDuration, maxSleepDuration);
+        }
+    }
+}
+
+
+void
+thread_squad::assign_chunks(std::uint32_t numChunks, int concurrency) noexcept
+{
+    auto impl = static_cast<detail::thread_squad_impl*>(handle_.get());
+    impl->wait_for_all_tasks();  // the chunk ranges must not be modified while an asynchronous task is running
+    impl->assign_chunks(numChunks, concurrency >= 0 ? std::min(concurrency, impl->numThreads) : impl->numThreads);
+}
+
+std::uint64_t
+thread_squad::do_run_async(detail::thread_squad_task* task, detail::thread_squad_task_deleter deleter) noexcept
+{
+    auto impl = static_cast<detail::thread_squad_impl*>(handle_.get());
+    return impl->submit(*task, deleter);
+}
+
 void
 thread_squad::do_run(detail::thread_squad_task& task)
 {
@@ -0,0 +1,101 @@
+
+#include <patton/algorithm.hpp>
+
+#include <span>
+#include <limits>
+#include <vector>
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t, int64_t, uint32_t
+#include <algorithm>  // for min(), max()
+
+#include <patton/memory.hpp>  // for aligned_allocator<>
+#include <patton/thread_squad.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+
+namespace {
+
+
+template <typename T>
+void
+check_parallel_reduce(patton::thread_squad& threadSquad, std::size_t n)
+{
+        // Small integers can be summed exactly in every floating-point type.
+    auto data = std::vector<T, patton::aligned_allocator<T, patton::cache_line_alignment>>(n);
+    for (std::size_t i = 0; i != n; ++i)
+    {
+        data[i] = T(i % 7) - T(3);
+    }
+    T expectedSum = { };
+    T expectedMin = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    T expectedMax = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+    for (T v : data)
+    {
+        expectedSum += v;
+        expectedMin = std::min(expectedMin, v);
+        expectedMax = std::max(expectedMax, v);
+    }
+
+    auto span = std::span<T const>(data);
+    CHECK(patton::parallel_reduce(threadSquad, span, patton::reduce_op::sum) == expectedSum);
+    CHECK(patton::parallel_reduce(threadSquad, span, patton::reduce_op::min) == expectedMin);
+    CHECK(patton::parallel_reduce(threadSquad, span, patton::reduce_op::max) == expectedMax);
+    CHECK(patton::parallel_reduce(threadSquad, span, patton::reduce_op::sum, 0) == T{ });
+}
+
+template <typename T>
+void
+check_parallel_dot(patton::thread_squad& threadSquad, std::size_t n)
+{
+    auto x = std::vector<T>(n);
+    auto y = std::vector<T>(n);
+    T expected = { };
+    for (std::size_t i = 0; i != n; ++i)
+    {
+        x[i] = T(i % 5);
+        y[i] = T(2) - T(i % 3);
+        expected += x[i]*y[i];
+    }
+    CHECK(patton::parallel_dot(threadSquad, std::span(x), std::span(y)) == expected);
+}
+
+
+TEST_CASE("parallel_reduce() computes sum, minimum, and maximum")
+{
+    std::size_t n = GENERATE(0, 1, 31, 33, 1000, 100000);
+    int numThreads = GENERATE(1, 4);
+    CAPTURE(n, numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    check_parallel_reduce<float>(threadSquad, n);
+    check_parallel_reduce<double>(threadSquad, n);
+    check_parallel_reduce<std::int32_t>(threadSquad, n);
+    check_parallel_reduce<std::int64_t>(threadSquad, n);
+}
+
+TEST_CASE("parallel_dot() computes the dot product")
+{
+    std::size_t n = GENERATE(0, 1, 17, 100000);
+    int numThreads = GENERATE(1, 3);
+    CAPTURE(n, numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    check_parallel_dot<float>(threadSquad, n);
+    check_parallel_dot<double>(threadSquad, n);
+    check_parallel_dot<std::int32_t>(threadSquad, n);
+    check_parallel_dot<std::int64_t>(threadSquad, n);
+}
+
+TEST_CASE("parallel_reduce() wraps around on integer overflow")
+{
+    auto threadSquad = patton::thread_squad({ .num_threads = 2 });
+
+    auto data = std::vector<std::int32_t>(100000, std::numeric_limits<std::int32_t>::max());
+    auto expected = std::int32_t(std::uint32_t(std::numeric_limits<std::int32_t>::max())*std::uint32_t(data.size()));
+    CHECK(patton::parallel_reduce(threadSquad, std::span(data), patton::reduce_op::sum) == expected);
+}
+
+
+} // anonymous namespace
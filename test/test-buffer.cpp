@@ -1,6 +1,12 @@
 
 #include <patton/buffer.hpp>
 
+#include <tuple>
+#include <string>
+#include <cstdint>     // for uintptr_t, int64_t
+#include <algorithm>   // for all_of()
+#include <functional>  // for plus<>
+
 #include <gsl-lite/gsl-lite.hpp>
 
 #include <catch2/catch_test_macros.hpp>
@@ -27,6 +33,127 @@ TEST_CASE("aligned_buffer<> properly aligns elements")
 }
 
 
+TEST_CASE("aligned_buffer<> can be constructed by a thread squad")
+{
+    constexpr std::size_t alignment = 4 * sizeof(int);
+    std::size_t numElements = GENERATE(0, 1, 5, 1000);
+    int numThreads = GENERATE(1, 3);
+    CAPTURE(numElements, numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    auto bufNI = patton::aligned_buffer<int, alignment>(threadSquad, numElements);
+    auto buf42 = patton::aligned_buffer<int, alignment>(threadSquad, numElements, 42,
+        { .kind = patton::thread_squad::schedule_kind::static_cyclic, .chunk_size = 16 });
+    CHECK(bufNI.size() == numElements);
+    CHECK(buf42.size() == numElements);
+    CHECK(std::all_of(bufNI.begin(), bufNI.end(), [](int v) { return v == 0; }));
+    CHECK(std::all_of(buf42.begin(), buf42.end(), [](int v) { return v == 42; }));
+
+    using PageAllocator = patton::page_allocator<int>;
+    auto bufP42 = patton::aligned_buffer<int, alignment, PageAllocator>(threadSquad, numElements*100, 42);
+    CHECK(std::all_of(bufP42.begin(), bufP42.end(), [](int v) { return v == 42; }));
+}
+
+TEST_CASE("aligned_buffer<> can use eagerly populated pages")
+{
+    constexpr std::size_t alignment = 4 * sizeof(int);
+    std::size_t numElements = GENERATE(1, 100000);
+
+    using Allocator = patton::page_allocator<int, patton::page_options::populate>;
+    auto buf42 = patton::aligned_buffer<int, alignment, Allocator>(numElements, 42);
+    CHECK(std::all_of(buf42.begin(), buf42.end(), [](int v) { return v == 42; }));
+}
+
+
+TEST_CASE("aligned_vector<> properly aligns elements")
+{
+    constexpr std::size_t alignment = 4 * sizeof(int);
+    std::size_t numElements = GENERATE(0, 1, 5, 1000);
+    CAPTURE(numElements);
+
+    auto vec = patton::aligned_vector<int, alignment>{ };
+    for (std::size_t i = 0; i != numElements; ++i)
+    {
+        vec.push_back(int(i));
+    }
+    CHECK(vec.size() == numElements);
+    CHECK(vec.capacity() >= numElements);
+    bool allAligned = true;
+    bool allPreserved = true;
+    for (std::size_t i = 0; i != numElements; ++i)
+    {
+        allAligned = allAligned && reinterpret_cast<std::uintptr_t>(&vec[i]) % alignment == 0;
+        allPreserved = allPreserved && vec[i] == int(i);
+    }
+    CHECK(allAligned);
+    CHECK(allPreserved);
+
+    auto vec42 = patton::aligned_vector<int, alignment>(numElements, 42);
+    CHECK(std::all_of(vec42.begin(), vec42.end(), [](int v) { return v == 42; }));
+    vec42.resize(numElements + 3);
+    CHECK(vec42.back() == 0);
+    vec42.resize(1);
+    CHECK(vec42.size() == 1);
+}
+
+TEST_CASE("aligned_vector<> handles elements which refer to the vector itself")
+{
+    auto vec = patton::aligned_vector<std::string, patton::cache_line_alignment>(1, std::string(100, 'x'));
+    for (int i = 0; i != 10; ++i)
+    {
+        vec.push_back(vec.front());
+    }
+    vec.resize(100, vec.back());
+    CHECK(vec.size() == 100);
+    CHECK(std::all_of(vec.begin(), vec.end(), [](std::string const& s) { return s == std::string(100, 'x'); }));
+    vec.pop_back();
+    CHECK(vec.size() == 99);
+    vec.clear();
+    CHECK(vec.empty());
+}
+
+TEST_CASE("aligned_vector<> grows page-allocated storage in place")
+{
+    constexpr std::size_t alignment = sizeof(double);
+    std::size_t pageSize = patton::hardware_page_size();
+
+    using PageAllocator = patton::page_allocator<double>;
+    auto vec = patton::aligned_vector<double, alignment, PageAllocator>{ };
+    std::size_t n = 0;
+    for (std::size_t newN : { std::size_t(1), pageSize, 3*pageSize, 100*pageSize, 5*pageSize })
+    {
+        CAPTURE(newN);
+        vec.resize_for_overwrite(newN);
+        for (std::size_t i = n; i < newN; ++i)
+        {
+            vec[i] = double(i);
+        }
+        n = newN;
+        bool allPreserved = true;
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            allPreserved = allPreserved && vec[i] == double(i);
+        }
+        CHECK(allPreserved);
+    }
+    vec.reserve(1000*pageSize);
+    CHECK(vec.capacity() >= 1000*pageSize);
+    CHECK(vec[n - 1] == double(n - 1));
+
+    using PopulatingPageAllocator = patton::page_allocator<double, patton::page_options::populate>;
+    auto vecP = patton::aligned_vector<double, alignment, PopulatingPageAllocator>(pageSize, 1.);
+    vecP.resize(10*pageSize, 2.);
+    CHECK(vecP[pageSize - 1] == 1.);
+    CHECK(vecP[10*pageSize - 1] == 2.);
+
+        // Elements which are not trivially copyable are moved to new storage.
+    auto vecS = patton::aligned_vector<std::string, alignment, patton::page_allocator<std::string>>(3, std::string(100, 'y'));
+    vecS.resize(5*pageSize);
+    CHECK(vecS[2] == std::string(100, 'y'));
+    CHECK(vecS[3].empty());
+}
+
+
 TEST_CASE("aligned_row_buffer<> properly aligns elements")
 {
     constexpr std::size_t alignment = 4 * sizeof(int);
@@ -40,5 +167,188 @@ TEST_CASE("aligned_row_buffer<> properly aligns elements")
     // TODO: add checks
 }
 
+TEST_CASE("aligned_row_buffer<> pads rows only to the alignment by default")
+{
+    constexpr std::size_t alignment = patton::cache_line_alignment;
+    std::size_t numCols = GENERATE(128, 1024, 4096, 1000);
+    CAPTURE(numCols);
+
+    auto buf = patton::aligned_row_buffer<float, alignment>(3, numCols);
+    auto rowDistance = std::size_t(reinterpret_cast<char const*>(buf[1].data()) - reinterpret_cast<char const*>(buf[0].data()));
+    std::size_t lineSize = patton::hardware_cache_line_size();
+    CHECK(rowDistance == (numCols * sizeof(float) + lineSize - 1) / lineSize * lineSize);
+}
+
+TEST_CASE("aligned_row_buffer<> can pad rows to avoid cache set aliasing")
+{
+    constexpr std::size_t alignment = patton::cache_line_alignment;
+    std::size_t numCols = GENERATE(128, 1024, 4096, 1000);
+    CAPTURE(numCols);
+
+    using Buffer = patton::aligned_row_buffer<float, alignment, patton::aligned_allocator<float, alignment>,
+        patton::row_padding::avoid_cache_aliasing>;
+    auto buf = Buffer(3, numCols);
+    auto rowDistance = std::size_t(reinterpret_cast<char const*>(buf[1].data()) - reinterpret_cast<char const*>(buf[0].data()));
+    CHECK(rowDistance >= numCols * sizeof(float));
+    CHECK(rowDistance % patton::hardware_cache_line_size() == 0);
+    CHECK(rowDistance % 4096 != 0);
+    CHECK(rowDistance - numCols * sizeof(float) <= 2*patton::hardware_cache_line_size());
+}
+
+
+TEST_CASE("aligned_tensor_buffer<> properly aligns rows")
+{
+    constexpr std::size_t alignment = 4 * sizeof(double);
+    std::size_t nx = GENERATE(0, 1, 3);
+    std::size_t ny = GENERATE(1, 5);
+    std::size_t nz = GENERATE(0, 1, 7, 512);
+    CAPTURE(nx, ny, nz);
+
+    auto grid = patton::aligned_tensor_buffer<double, 3, alignment>({ nx, ny, nz }, 42.);
+    CHECK(grid.size() == nx*ny*nz);
+    CHECK(grid.stride(2) == 1);
+    CHECK(grid.stride(1) >= nz);
+    CHECK(grid.stride(1) * sizeof(double) % alignment == 0);
+    CHECK((nz == 0 || grid.stride(1) * sizeof(double) % 4096 != 0));
+    CHECK(grid.stride(0) == grid.stride(1) * ny);
+
+    bool allAligned = true;
+    bool allInitialized = true;
+    for (std::size_t i = 0; i != nx; ++i)
+    {
+        for (std::size_t j = 0; j != ny; ++j)
+        {
+            allAligned = allAligned && nz != 0 && reinterpret_cast<std::uintptr_t>(&grid(i, j, 0)) % alignment == 0;
+            for (std::size_t k = 0; k != nz; ++k)
+            {
+                allInitialized = allInitialized && grid(i, j, k) == 42.;
+                grid(i, j, k) = double(i*10000 + j*1000 + k);
+            }
+        }
+    }
+    if (nx != 0 && nz != 0)
+    {
+        CHECK(allAligned);
+    }
+    CHECK(allInitialized);
+    if (grid.size() != 0)
+    {
+        CHECK(grid[{ nx - 1, ny - 1, nz - 1 }] == double((nx - 1)*10000 + (ny - 1)*1000 + nz - 1));
+        CHECK(grid.data()[(nx - 1)*grid.stride(0) + (ny - 1)*grid.stride(1) + nz - 1] == grid(nx - 1, ny - 1, nz - 1));
+    }
+}
+
+TEST_CASE("aligned_tensor_buffer<> can use page-granular allocators")
+{
+    auto vec = patton::aligned_tensor_buffer<float, 1, patton::page_alignment, patton::page_allocator<float>>({ 100000 }, 1.f);
+    CHECK(reinterpret_cast<std::uintptr_t>(vec.data()) % patton::hardware_page_size() == 0);
+    CHECK(vec(99999) == 1.f);
+
+    auto mat = patton::aligned_tensor_buffer<float, 2, patton::cache_line_alignment, patton::page_allocator<float>>({ 100, 1000 });
+    CHECK(mat.stride(0) * sizeof(float) % patton::hardware_cache_line_size() == 0);
+    CHECK(mat(99, 999) == 0.f);
+
+    if (patton::hardware_large_page_size() != 0)
+    {
+        using LargePageAllocator = patton::large_page_allocator<double>;
+        auto lmat = patton::aligned_tensor_buffer<double, 2, patton::cache_line_alignment, LargePageAllocator>({ 512, 512 });
+        CHECK(lmat.stride(0) > 512);  // 512 doubles per row would be a multiple of 4 KiB
+        CHECK(lmat(511, 511) == 0.);
+    }
+}
+
+
+TEST_CASE("aligned_soa_buffer<> properly aligns fields")
+{
+    constexpr std::size_t alignment = 4 * sizeof(double);
+    std::size_t numElements = GENERATE(0, 1, 5, 1000);
+    CAPTURE(numElements);
+
+    using Particles = patton::aligned_soa_buffer<std::tuple<float, float, double, char>, alignment>;
+    auto particles = Particles(numElements, { 1.f, 2.f, 3., 'a' });
+    CHECK(particles.size() == numElements);
+    CHECK(particles.field<0>().size() == numElements);
+    CHECK(particles.field<3>().size() == numElements);
+    if (numElements != 0)
+    {
+        CHECK(reinterpret_cast<std::uintptr_t>(particles.field<0>().data()) % alignment == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(particles.field<1>().data()) % alignment == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(particles.field<2>().data()) % alignment == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(particles.field<3>().data()) % alignment == 0);
+        CHECK(static_cast<void*>(particles.field<1>().data()) >= static_cast<void*>(particles.field<0>().data() + numElements));
+    }
+    CHECK(std::all_of(particles.field<0>().begin(), particles.field<0>().end(), [](float v) { return v == 1.f; }));
+    CHECK(std::all_of(particles.field<3>().begin(), particles.field<3>().end(), [](char v) { return v == 'a'; }));
+
+    for (std::size_t i = 0; i != numElements; ++i)
+    {
+        auto [x, y, z, tag] = particles[i];
+        x = float(i);
+        z += y;
+    }
+    std::size_t i = 0;
+    bool allUpdated = true;
+    for (auto [x, y, z, tag] : particles)
+    {
+        allUpdated = allUpdated && x == float(i) && y == 2.f && z == 5. && tag == 'a';
+        ++i;
+    }
+    CHECK(allUpdated);
+    CHECK(i == numElements);
+
+    auto const& cparticles = particles;
+    CHECK(cparticles.end() - cparticles.begin() == std::ptrdiff_t(numElements));
+    if (numElements != 0)
+    {
+        particles.back() = std::tuple(-1.f, -2.f, -3., 'z');
+        CHECK(std::get<3>(cparticles[numElements - 1]) == 'z');
+        CHECK(particles.field<1>().back() == -2.f);
+    }
+
+    auto moved = std::move(particles);
+    CHECK(moved.size() == numElements);
+    CHECK(particles.empty());
+}
+
+TEST_CASE("aligned_soa_buffer<> value-initializes fields")
+{
+    auto buf = patton::aligned_soa_buffer<std::tuple<int, std::string>, patton::cache_line_alignment>(10);
+    CHECK(std::all_of(buf.field<0>().begin(), buf.field<0>().end(), [](int v) { return v == 0; }));
+    CHECK(std::all_of(buf.field<1>().begin(), buf.field<1>().end(), [](std::string const& s) { return s.empty(); }));
+}
+
+TEST_CASE("per_thread<> holds one aligned slot per thread")
+{
+    int numThreads = GENERATE(1, 3, 8);
+    CAPTURE(numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    auto counts = patton::per_thread<std::int64_t>(threadSquad);
+    REQUIRE(counts.size() == std::size_t(numThreads));
+    for (std::size_t i = 0; i != counts.size(); ++i)
+    {
+        CHECK(counts[i] == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(&counts[i]) % patton::hardware_cache_line_size() == 0);
+    }
+
+    threadSquad.run(
+        [&](patton::thread_squad::task_context& ctx)
+        {
+            counts.local(ctx) += ctx.thread_index() + 1;
+        });
+    CHECK(counts.combine(threadSquad, 0, std::plus<>{ }) == numThreads*(numThreads + 1)/2);
+
+    counts.for_each(threadSquad, [](std::int64_t& count) { count = 1; });
+    CHECK(std::all_of(counts.begin(), counts.end(), [](std::int64_t v) { return v == 1; }));
+    CHECK(counts.combine(threadSquad, 42, std::plus<>{ }) == 42 + numThreads);
+
+    auto pageSlots = patton::per_thread<int, patton::page_alignment>(threadSquad, 7);
+    for (std::size_t i = 0; i != pageSlots.size(); ++i)
+    {
+        CHECK(pageSlots[i] == 7);
+        CHECK(reinterpret_cast<std::uintptr_t>(&pageSlots[i]) % patton::hardware_page_size() == 0);
+    }
+}
+
 
 } // anonymous namespace
@@ -1,8 +1,23 @@
 
 #include <patton/memory.hpp>
+#include <patton/new.hpp>     // for hardware_page_size(), hardware_large_page_size(), hardware_large_page_sizes(), hardware_cache_line_size()
+#include <patton/thread.hpp>  // for numa_node_count()
 
+#include <patton/detail/cpuinfo.hpp>  // for numa_node_os_id()
+
+#include <new>      // for bad_alloc
+#include <list>
+#include <thread>
 #include <vector>
-#include <memory>  // for allocator<>
+#include <algorithm>  // for is_sorted(), find(), all_of(), sort(), adjacent_find()
+#include <memory>   // for allocator<>
+#include <cstdint>  // for uintptr_t
+#include <set>
+
+#if defined(__linux__)
+# include <unistd.h>       // for syscall()
+# include <sys/syscall.h>  // for SYS_move_pages
+#endif // defined(__linux__)
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
@@ -12,6 +27,20 @@
 namespace {
 
 
+#if defined(__linux__)
+    // Returns the OS id of the NUMA node on which the page containing the given address resides, or -1 if the node cannot be
+    // determined.
+int
+os_numa_node_of_page(void const* ptr)
+{
+    void* page = const_cast<void*>(ptr);
+    int status = -1;
+    long result = ::syscall(SYS_move_pages, 0, 1UL, &page, nullptr, &status, 0);
+    return result == 0 && status >= 0 ? status : -1;
+}
+#endif // defined(__linux__)
+
+
 TEST_CASE("aligned_allocator<> properly aligns allocations")
 {
     constexpr std::size_t alignment = 4 * sizeof(int);
@@ -36,6 +65,268 @@ TEST_CASE("aligned_allocator_adaptor<> properly aligns allocations")
     // TODO: add checks
 }
 
+TEST_CASE("pool_allocator<> serves aligned blocks")
+{
+    struct node
+    {
+        node* next;
+        int value;
+    };
+
+    SECTION("cache line alignment")
+    {
+        using Allocator = patton::pool_allocator<node, patton::cache_line_alignment>;
+        auto l = std::list<node, Allocator>{ };
+        for (int i = 0; i < 10000; ++i)
+        {
+            l.push_back(node{ nullptr, i });
+        }
+        CHECK(std::all_of(l.begin(), l.end(),
+            [](node const& n) { return reinterpret_cast<std::uintptr_t>(&n) % alignof(node) == 0; }));
+        l.clear();
+
+        auto alloc = patton::pool_allocator<node, patton::cache_line_alignment>{ };
+        auto nodes = std::vector<node*>(1000);
+        for (auto& n : nodes)
+        {
+            n = alloc.allocate(1);
+            CHECK(reinterpret_cast<std::uintptr_t>(n) % patton::hardware_cache_line_size() == 0);
+        }
+        for (auto n : nodes)
+        {
+            alloc.deallocate(n, 1);
+        }
+    }
+    SECTION("page alignment")
+    {
+        auto alloc = patton::pool_allocator<node, patton::page_alignment>{ };
+        node* n1 = alloc.allocate(1);
+        node* n2 = alloc.allocate(1);
+        CHECK(n1 != n2);
+        CHECK(reinterpret_cast<std::uintptr_t>(n1) % patton::hardware_page_size() == 0);
+        CHECK(reinterpret_cast<std::uintptr_t>(n2) % patton::hardware_page_size() == 0);
+        alloc.deallocate(n1, 1);
+        alloc.deallocate(n2, 1);
+    }
+    SECTION("blocks of types with small alignment")
+    {
+        struct bytes
+        {
+            char data[9];
+        };
+        auto alloc = patton::pool_allocator<bytes>{ };
+        auto blocks = std::vector<bytes*>(100);
+        for (auto& b : blocks)
+        {
+            b = alloc.allocate(1);
+            CHECK(reinterpret_cast<std::uintptr_t>(b) % alignof(void*) == 0);
+        }
+        for (auto b : blocks)
+        {
+            alloc.deallocate(b, 1);
+        }
+    }
+    SECTION("array allocations")
+    {
+        auto v = std::vector<node, patton::pool_allocator<node, patton::cache_line_alignment>>(100);
+        CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % patton::hardware_cache_line_size() == 0);
+    }
+    SECTION("blocks deallocated by other threads")
+    {
+        using Allocator = patton::pool_allocator<node>;
+        constexpr int numNodes = 10000;
+        auto nodes = std::vector<node*>(numNodes);
+        auto producer = std::thread([&nodes]
+        {
+            auto alloc = Allocator{ };
+            for (int i = 0; i < numNodes; ++i)
+            {
+                nodes[i] = alloc.allocate(1);
+                nodes[i]->value = i;
+            }
+        });
+        producer.join();
+        bool valuesAreCorrect = true;
+        auto consumer = std::thread([&nodes, &valuesAreCorrect]
+        {
+            auto alloc = Allocator{ };
+            for (int i = 0; i < numNodes; ++i)
+            {
+                valuesAreCorrect &= nodes[i]->value == i;
+                alloc.deallocate(nodes[i], 1);
+            }
+        });
+        consumer.join();
+        CHECK(valuesAreCorrect);
+
+            // The blocks returned to the depot can be reused.
+        auto alloc = Allocator{ };
+        for (int i = 0; i < numNodes; ++i)
+        {
+            nodes[i] = alloc.allocate(1);
+        }
+        std::sort(nodes.begin(), nodes.end());
+        CHECK(std::adjacent_find(nodes.begin(), nodes.end()) == nodes.end());
+        for (int i = 0; i < numNodes; ++i)
+        {
+            alloc.deallocate(nodes[i], 1);
+        }
+    }
+    SECTION("blocks allocated and deallocated after the thread-local caches were torn down")
+    {
+        using Allocator = patton::pool_allocator<node>;
+        struct late_user
+        {
+            std::list<node, Allocator> l;
+
+            ~late_user()
+            {
+                l.push_back(node{ nullptr, -1 });
+                l.clear();
+            }
+        };
+        auto thread = std::thread([]
+        {
+                // The object is constructed before the thread-local caches are set up, hence it is destroyed after they have
+                // been torn down.
+            thread_local auto user = late_user{ };
+            for (int i = 0; i < 1000; ++i)
+            {
+                user.l.push_back(node{ nullptr, i });
+            }
+        });
+        thread.join();
+    }
+}
+
+TEST_CASE("numa_allocator<> allocates page-aligned memory on the requested nodes")
+{
+    int numNodes = patton::numa_node_count();
+    int node = GENERATE(range(-1, 4));
+    if (node >= numNodes) return;
+
+    using Allocator = patton::numa_allocator<int>;
+    static_assert(patton::aligned_allocator_traits<Allocator>::provides_static_alignment(patton::page_alignment));
+
+    auto alloc = node == patton::numa_interleaved ? Allocator{ } : Allocator(node);
+    CHECK(alloc.node() == node);
+    CHECK(alloc == patton::numa_allocator<char>(alloc));
+
+    std::size_t numElements = GENERATE(1, 1000, 100000);
+    auto v = std::vector<int, Allocator>(numElements, 42, alloc);
+    CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % patton::hardware_page_size() == 0);
+    for (std::size_t i = 0; i < numElements; ++i)
+    {
+        v[i] += int(i);
+    }
+    CHECK(v.back() == 42 + int(numElements - 1));
+
+#if defined(__linux__)
+    if (numNodes > 1)
+    {
+            // All pages have been touched, so we can query the nodes they were placed on.
+        std::size_t pageSize = patton::hardware_page_size();
+        auto bytes = reinterpret_cast<char const*>(v.data());
+        auto pageNodes = std::multiset<int>{ };
+        for (std::size_t offset = 0; offset < numElements*sizeof(int); offset += pageSize)
+        {
+            pageNodes.insert(os_numa_node_of_page(bytes + offset));
+        }
+        if (pageNodes.count(-1) != 0)
+        {
+            WARN("page placement could not be queried");
+        }
+        else if (node == patton::numa_interleaved)
+        {
+            std::size_t numPages = pageNodes.size();
+            if (numPages >= std::size_t(numNodes))
+            {
+                CHECK(pageNodes.count(*pageNodes.begin()) < numPages);
+            }
+        }
+        else
+        {
+            CHECK(pageNodes.count(patton::detail::numa_node_os_id(node)) == pageNodes.size());
+        }
+    }
+#endif // defined(__linux__)
+}
+
+TEST_CASE("hardware_large_page_sizes() lists the supported large page sizes")
+{
+    auto pageSizes = patton::hardware_large_page_sizes();
+    CHECK(std::is_sorted(pageSizes.begin(), pageSizes.end()));
+    for (std::size_t pageSize : pageSizes)
+    {
+        CHECK(pageSize % patton::hardware_page_size() == 0);
+    }
+    if (patton::hardware_large_page_size() != 0 && !pageSizes.empty())
+    {
+        CHECK(std::find(pageSizes.begin(), pageSizes.end(), patton::hardware_large_page_size()) != pageSizes.end());
+    }
+}
+
+TEST_CASE("explicit_large_page_allocator<> allocations are backed by large pages")
+{
+    using Allocator = patton::explicit_large_page_allocator<char>;
+    static_assert(patton::aligned_allocator_traits<Allocator>::provides_static_alignment(patton::large_page_alignment));
+
+    if (patton::hardware_large_page_sizes().empty()) return;
+
+    std::size_t numElements = GENERATE(1, patton::hardware_large_page_size() + 1);
+    auto alloc = Allocator{ };
+    char* data;
+    try
+    {
+        data = alloc.allocate(numElements);
+    }
+    catch (std::bad_alloc const&)
+    {
+        return;  // no large pages reserved
+    }
+    CHECK(reinterpret_cast<std::uintptr_t>(data) % patton::hardware_large_page_size() == 0);
+    std::fill(data, data + numElements, char(1));
+    CHECK(patton::large_page_backed_size(data, numElements) == numElements);
+    alloc.deallocate(data, numElements);
+}
+
+TEST_CASE("large_page_backed_size() does not report base pages")
+{
+    auto v = std::vector<char, patton::page_allocator<char>>(4*patton::hardware_page_size(), char(1));
+    CHECK(patton::large_page_backed_size(v.data(), v.size()) == 0);
+}
+
+TEST_CASE("prefault_pages() preserves memory contents")
+{
+    using Allocator = patton::page_allocator<int>;
+    auto v = std::vector<int, Allocator>(100000);
+    for (std::size_t i = 0; i < v.size(); i += 7)
+    {
+        v[i] = int(i);
+    }
+    std::size_t offset = GENERATE(0, 1, 999);
+    patton::prefault_pages(v.data() + offset, (v.size() - offset)*sizeof(int));
+    bool contentsPreserved = true;
+    for (std::size_t i = 0; i < v.size(); ++i)
+    {
+        contentsPreserved &= v[i] == (i % 7 == 0 ? int(i) : 0);
+    }
+    CHECK(contentsPreserved);
+}
+
+TEST_CASE("page-granular allocators can populate pages eagerly")
+{
+    std::size_t numElements = GENERATE(1, 1000, 100000);
+
+    auto v1 = std::vector<int, patton::page_allocator<int, patton::page_options::populate>>(numElements, 42);
+    CHECK(v1.back() == 42);
+    if (patton::hardware_large_page_size() != 0)
+    {
+        auto v2 = std::vector<int, patton::large_page_allocator<int, patton::page_options::populate>>(numElements, 42);
+        CHECK(v2.back() == 42);
+    }
+}
+
 // TODO: add tests for allocate_unique<>()
 
 
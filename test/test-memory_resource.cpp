@@ -0,0 +1,94 @@
+
+#include <patton/new.hpp>  // for hardware_page_size(), hardware_cache_line_size(), hardware_large_page_size()
+#include <patton/memory_resource.hpp>
+
+#include <vector>
+#include <cstdint>          // for uintptr_t
+#include <algorithm>        // for all_of()
+#include <memory_resource>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+
+namespace {
+
+
+bool
+is_aligned(void const* ptr, std::size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+
+TEST_CASE("aligned_memory_resource aligns allocations")
+{
+    auto resource = patton::aligned_memory_resource(patton::cache_line_alignment);
+    CHECK(resource == patton::aligned_memory_resource(patton::cache_line_alignment));
+    CHECK(resource != patton::aligned_memory_resource(patton::page_alignment));
+
+    std::size_t numElements = GENERATE(1, 3, 1000);
+    auto v = std::pmr::vector<char>(numElements, 'x', &resource);
+    CHECK(is_aligned(v.data(), patton::hardware_cache_line_size()));
+    CHECK(std::all_of(v.begin(), v.end(), [](char c) { return c == 'x'; }));
+}
+
+TEST_CASE("page_memory_resource and large_page_memory_resource obtain page-aligned memory")
+{
+    auto options = GENERATE(patton::page_options::none, patton::page_options::populate);
+    std::size_t numElements = GENERATE(1, 100000);
+
+    auto pageResource = patton::page_memory_resource(options);
+    CHECK(pageResource == patton::page_memory_resource{ });
+    auto v1 = std::pmr::vector<int>(numElements, 42, &pageResource);
+    CHECK(is_aligned(v1.data(), patton::hardware_page_size()));
+    CHECK(v1.back() == 42);
+    void* p = pageResource.allocate(0);
+    pageResource.deallocate(p, 0);
+
+    if (patton::hardware_large_page_size() != 0)
+    {
+        auto largePageResource = patton::large_page_memory_resource(options);
+        auto v2 = std::pmr::vector<int>(numElements, 42, &largePageResource);
+        CHECK(is_aligned(v2.data(), patton::hardware_page_size()));
+        CHECK(v2.back() == 42);
+    }
+}
+
+TEST_CASE("aligned_monotonic_buffer_resource aligns allocations")
+{
+    auto upstream = patton::page_memory_resource{ };
+    auto resource = patton::aligned_monotonic_buffer_resource(patton::cache_line_alignment, 4096, &upstream);
+    CHECK(resource.upstream_resource() == &upstream);
+    CHECK(resource.alignment() == patton::cache_line_alignment);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        auto ptrs = std::vector<char*>{ };
+        bool allocationsAreAligned = true;
+        for (std::size_t size : { 1, 7, 64, 100, 5000, 3, 1 << 20, 0, 12 })
+        {
+            auto ptr = static_cast<char*>(resource.allocate(size));
+            allocationsAreAligned &= is_aligned(ptr, patton::hardware_cache_line_size());
+            std::fill(ptr, ptr + size, char(size));
+            ptrs.push_back(ptr);
+        }
+        auto pagePtr = resource.allocate(10, patton::hardware_page_size());
+        allocationsAreAligned &= is_aligned(pagePtr, patton::hardware_page_size());
+        CHECK(allocationsAreAligned);
+        CHECK(ptrs[6][(1 << 20) - 1] == char(1 << 20));
+        CHECK(ptrs[4][4999] == char(5000));
+        resource.release();
+    }
+
+    auto l = std::pmr::vector<std::pmr::vector<int>>(&resource);
+    for (int i = 0; i < 100; ++i)
+    {
+        l.emplace_back(std::size_t(i), i);
+    }
+    CHECK(l.back().size() == 99);
+    CHECK(is_aligned(l.back().data(), patton::hardware_cache_line_size()));
+}
+
+
+} // anonymous namespace
@@ -4,6 +4,7 @@
 #include <patton/thread.hpp>
 
 #include <iostream>
+#include <algorithm>  // for is_sorted()
 
 #include <gsl-lite/gsl-lite.hpp>
 
@@ -42,3 +43,28 @@ TEST_CASE("physical_core_ids() returns correct number of thread ids")
         CHECK(physicalCoreIds.size() == physicalConcurrency);
     }
 }
+
+TEST_CASE("NUMA topology is consistent")
+{
+    int numNodes = patton::numa_node_count();
+    std::cout << "NUMA nodes: " << numNodes << "\n";
+    REQUIRE(numNodes >= 1);
+
+    std::size_t numHardwareThreads = 0;
+    for (int node = 0; node < numNodes; ++node)
+    {
+        CAPTURE(node);
+        auto hardwareThreadIds = patton::numa_node_hardware_thread_ids(node);
+        numHardwareThreads += hardwareThreadIds.size();
+        CHECK(std::is_sorted(hardwareThreadIds.begin(), hardwareThreadIds.end()));
+        for (int id : hardwareThreadIds)
+        {
+            CHECK(patton::numa_node_of_hardware_thread(id) == node);
+        }
+        for (int otherNode = 0; otherNode < numNodes; ++otherNode)
+        {
+            CHECK(patton::numa_node_distance(node, otherNode) >= patton::numa_node_distance(node, node));
+        }
+    }
+    CHECK(numHardwareThreads >= patton::physical_concurrency());
+}
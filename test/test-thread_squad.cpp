@@ -1,10 +1,18 @@
 ﻿
 #include <patton/thread.hpp>
+#include <patton/new.hpp>     // for hardware_cache_line_size()
+#include <patton/memory.hpp>  // for arena_allocator<>
+#include <patton/buffer.hpp>
 #include <patton/thread_squad.hpp>
 
+#include <atomic>
+#include <cstdint>  // for uintptr_t
+#include <chrono>
 #include <thread>
 #include <mutex>
+#include <vector>
 #include <algorithm>
+#include <functional>  // for plus<>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -220,4 +228,440 @@ TEST_CASE("thread_squad")
             CHECK(reducedSumIsCorrectForEveryThread);
         }
     }
+
+    SECTION("split barrier")
+    {
+        int numRounds = 10;
+
+        auto threadSquad = patton::thread_squad(params);
+        for (int i = 1; i <= int(numActualThreads); ++i)
+        {
+            CAPTURE(i);
+            auto values = std::vector<int>(static_cast<std::size_t>(i));
+            bool valuesAreCorrectForEveryThread = threadSquad.transform_reduce_first(
+                [&values, numRounds]
+                (patton::thread_squad::task_context& ctx)
+                {
+                    bool correct = true;
+                    for (int round = 1; round <= numRounds; ++round)
+                    {
+                        values[static_cast<std::size_t>(ctx.thread_index())] = round;
+                        auto token = ctx.arrive();
+                        for (int j = 0; j != 100*ctx.thread_index(); ++j)
+                        {
+                            volatile int local = j;  // simulate work overlapping with the synchronization
+                            (void) local;
+                        }
+                        ctx.wait(std::move(token));
+                        correct = correct && std::all_of(values.begin(), values.end(), [round](int v) { return v == round; });
+                        ctx.synchronize();
+                    }
+                    return correct;
+                },
+                std::logical_and<>{ },
+                i);
+            CHECK(valuesAreCorrectForEveryThread);
+        }
+    }
+}
+
+#ifdef THREAD_PINNING_SUPPORTED
+TEST_CASE("thread_squad placement policies")
+{
+    using placement_policy = patton::thread_squad::placement_policy;
+
+    auto placement = GENERATE(placement_policy::compact, placement_policy::scatter, placement_policy::cores_first);
+    CAPTURE(placement);
+
+    int numHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int numThreads = GENERATE_COPY(1, 2, numHardwareThreads, 2*numHardwareThreads);
+    CAPTURE(numThreads);
+
+    auto threadSquad = patton::thread_squad({
+        .num_threads = numThreads,
+        .pin_to_hardware_threads = true,
+        .placement = placement
+    });
+    auto count = std::atomic<int>(0);
+    threadSquad.run(
+        [&count]
+        (patton::thread_squad::task_context&)
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+        });
+    CHECK(count.load() == numThreads);
+}
+#endif // THREAD_PINNING_SUPPORTED
+
+TEST_CASE("thread_squad wait policies")
+{
+    using wait_policy = patton::thread_squad::wait_policy;
+
+    auto wait = GENERATE(wait_policy::block, wait_policy::spin, wait_policy::adaptive_spin);
+    CAPTURE(wait);
+
+    int numHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int numThreads = GENERATE_COPY(1, 3, numHardwareThreads, 2*numHardwareThreads);
+    CAPTURE(numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads, .wait = wait });
+
+        // Alternate between bursts of tasks and idle periods so that both short and long waits are observed.
+    for (int burst = 0; burst != 4; ++burst)
+    {
+        for (int i = 0; i != 50; ++i)
+        {
+            int sum = threadSquad.transform_reduce(
+                [](patton::thread_squad::task_context& ctx)
+                {
+                    return ctx.thread_index() + 1;
+                },
+                0, std::plus<>{ });
+            CHECK(sum == numThreads*(numThreads + 1)/2);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_CASE("thread_squad broadcast wake")
+{
+    int numHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int numThreads = GENERATE_COPY(1, 2, 9, numHardwareThreads, 2*numHardwareThreads);
+    CAPTURE(numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads, .broadcast_wake = true });
+    for (int repetition = 0; repetition != 3; ++repetition)
+    {
+            // Run tasks with varying concurrency so that some threads are woken without participating.
+        for (int concurrency = 0; concurrency <= numThreads; ++concurrency)
+        {
+            int sum = threadSquad.transform_reduce(
+                [](patton::thread_squad::task_context& ctx)
+                {
+                    return ctx.thread_index() + 1;
+                },
+                0, std::plus<>{ }, concurrency);
+            CHECK(sum == concurrency*(concurrency + 1)/2);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto count = std::atomic<int>(0);
+    auto handles = std::vector<patton::thread_squad::completion_handle>{ };
+    for (int i = 0; i != 20; ++i)
+    {
+        handles.push_back(threadSquad.run_async(
+            [&count]
+            (patton::thread_squad::task_context&)
+            {
+                count.fetch_add(1, std::memory_order_relaxed);
+            }));
+    }
+    for (auto& handle : handles)
+    {
+        handle.wait();
+    }
+    CHECK(count.load() == 20*numThreads);
+}
+
+TEST_CASE("thread_squad broadcast wake with oversubscription")
+{
+    int numHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int numThreads = GENERATE_COPY(17, 2*numHardwareThreads);
+    CAPTURE(numThreads);
+
+        // Intermediate threads of the synchronization tree must not see the completion flags of their subordinate threads
+        // from the previous task, or else they merge stale results.
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads, .broadcast_wake = true });
+    for (int i = 0; i != 2000; ++i)
+    {
+        int concurrency = numThreads - i % 3;
+        int sum = threadSquad.transform_reduce(
+            [i]
+            (patton::thread_squad::task_context& ctx)
+            {
+                return ctx.thread_index() + i;
+            },
+            0, std::plus<>{ }, concurrency);
+        REQUIRE(sum == concurrency*(concurrency - 1)/2 + concurrency*i);
+    }
+}
+
+TEST_CASE("thread_squad tree topologies")
+{
+    using tree_topology = patton::thread_squad::tree_topology;
+    using schedule_kind = patton::thread_squad::schedule_kind;
+
+    auto topology = GENERATE(tree_topology::uniform, tree_topology::flat, tree_topology::hardware);
+    int treeBreadth = GENERATE(2, 3, 8);
+    CAPTURE(topology, treeBreadth);
+
+    int numHardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int numThreads = GENERATE_COPY(1, 2, 9, 17, numHardwareThreads, 2*numHardwareThreads);
+    CAPTURE(numThreads);
+
+    auto params = patton::thread_squad::params{
+        .num_threads = numThreads,
+        .topology = topology,
+        .tree_breadth = treeBreadth
+    };
+#ifdef THREAD_PINNING_SUPPORTED
+    params.pin_to_hardware_threads = GENERATE(false, true);
+    params.placement = patton::thread_squad::placement_policy::compact;
+    CAPTURE(params.pin_to_hardware_threads);
+#endif // THREAD_PINNING_SUPPORTED
+
+    auto threadSquad = patton::thread_squad(params);
+    for (int concurrency = 0; concurrency <= numThreads; ++concurrency)
+    {
+        int sum = threadSquad.transform_reduce(
+            [](patton::thread_squad::task_context& ctx)
+            {
+                ctx.synchronize();
+                return ctx.thread_index() + 1;
+            },
+            0, std::plus<>{ }, concurrency);
+        CHECK(sum == concurrency*(concurrency + 1)/2);
+    }
+
+        // Work stealing chooses victims along the tree.
+    auto visits = std::vector<std::atomic<int>>(1000);
+    threadSquad.for_each_index(0, std::ssize(visits),
+        [&visits]
+        (std::ptrdiff_t i)
+        {
+            visits[static_cast<std::size_t>(i)].fetch_add(1, std::memory_order_relaxed);
+        },
+        { .kind = schedule_kind::work_stealing });
+    CHECK(std::all_of(visits.begin(), visits.end(), [](std::atomic<int> const& v) { return v.load() == 1; }));
+}
+
+TEST_CASE("thread_squad with subtrees truncated in the middle of the tree")
+{
+        // With 81 threads, the synchronization tree has subtrees of 11 and 2 threads, so the subtree of thread 10 is truncated
+        // to a single thread by its superordinate subtree [0, 11) rather than by the end of the thread range.
+    int numThreads = GENERATE(81, 100);
+    CAPTURE(numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    for (int concurrency : { numThreads, numThreads - 1, 12 })
+    {
+        int sum = threadSquad.transform_reduce(
+            [](patton::thread_squad::task_context& ctx)
+            {
+                ctx.synchronize();
+                return ctx.thread_index() + 1;
+            },
+            0, std::plus<>{ }, concurrency);
+        CHECK(sum == concurrency*(concurrency + 1)/2);
+    }
+}
+
+TEST_CASE("thread_squad::run_async()")
+{
+    int numThreads = GENERATE(1, 2, 3, 8);
+    CAPTURE(numThreads);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    auto count = std::atomic<int>(0);
+    auto action = [&count]
+    (patton::thread_squad::task_context&)
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    SECTION("wait()")
+    {
+        auto handle = threadSquad.run_async(action);
+        handle.wait();
+        CHECK(count.load() == numThreads);
+        CHECK(handle.try_wait());
+    }
+    SECTION("try_wait()")
+    {
+        auto handle = threadSquad.run_async(action);
+        while (!handle.try_wait())
+        {
+            std::this_thread::yield();
+        }
+        CHECK(count.load() == numThreads);
+    }
+    SECTION("wait_for()")
+    {
+        auto release = std::atomic<bool>(false);
+        auto handle = threadSquad.run_async(
+            [&release]
+            (patton::thread_squad::task_context&)
+            {
+                while (!release.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+            });
+        CHECK_FALSE(handle.wait_for(std::chrono::milliseconds(1)));
+        release.store(true, std::memory_order_release);
+        CHECK(handle.wait_for(std::chrono::seconds(60)));
+    }
+    SECTION("subsequent operations wait for completion")
+    {
+        auto handle1 = threadSquad.run_async(action);
+        auto handle2 = threadSquad.run_async(action, 1);
+        threadSquad.run(action);
+        CHECK(count.load() == 2*numThreads + 1);
+        CHECK(handle1.try_wait());
+        CHECK(handle2.try_wait());
+    }
+    SECTION("pipelined tasks")
+    {
+            // Tasks must be executed in submission order, as if `run()` had been called back to back.
+        int numTasks = 50;
+        auto lastTaskIndices = std::vector<int>(static_cast<std::size_t>(numThreads), -1);
+        auto taskOrderIsCorrect = std::atomic<bool>(true);
+        auto handles = std::vector<patton::thread_squad::completion_handle>{ };
+        for (int i = 0; i < numTasks; ++i)
+        {
+            handles.push_back(threadSquad.run_async(
+                [&lastTaskIndices, &taskOrderIsCorrect, i]
+                (patton::thread_squad::task_context& ctx)
+                {
+                    auto& lastTaskIndex = lastTaskIndices[static_cast<std::size_t>(ctx.thread_index())];
+                    if (lastTaskIndex >= i)
+                    {
+                        taskOrderIsCorrect.store(false);
+                    }
+                    lastTaskIndex = i;
+                    ctx.synchronize();
+                },
+                1 + i % numThreads));
+        }
+        CHECK(handles.back().wait_for(std::chrono::seconds(60)));
+        for (auto& handle : handles)
+        {
+            CHECK(handle.try_wait());
+        }
+        CHECK(taskOrderIsCorrect.load());
+    }
+    SECTION("handle destructor waits for completion")
+    {
+        {
+            auto handle = threadSquad.run_async(action);
+        }
+        CHECK(count.load() == numThreads);
+    }
+}
+
+TEST_CASE("thread_squad task arenas")
+{
+    int numThreads = GENERATE(1, 3, 8);
+    std::size_t arenaSize = GENERATE(std::size_t(0), std::size_t(1) << 16);
+    CAPTURE(numThreads, arenaSize);
+
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads, .arena_size = arenaSize });
+    auto arenasAreReset = std::atomic<bool>(true);
+    auto allocationsAreCorrect = std::atomic<bool>(true);
+    auto action = [&, arenaSize]
+    (patton::thread_squad::task_context ctx)
+    {
+        auto& arena = ctx.arena();
+        if (arena.size() != 0) arenasAreReset = false;
+        if (arena.capacity() < arenaSize) allocationsAreCorrect = false;
+
+        auto v = std::vector<int, patton::arena_allocator<int>>(100, ctx.thread_index(), patton::arena_allocator<int>(arena));
+        if ((arenaSize != 0) != (arena.size() != 0)) allocationsAreCorrect = false;
+        auto buf = patton::aligned_buffer<double, patton::cache_line_alignment, patton::arena_allocator<double>>(
+            10, patton::arena_allocator<double>(arena));
+        if (reinterpret_cast<std::uintptr_t>(&buf[0]) % patton::hardware_cache_line_size() != 0) allocationsAreCorrect = false;
+
+            // Allocations which do not fit into the arena are served by `operator new()`.
+        auto large = std::vector<char, patton::arena_allocator<char>>(arenaSize + 1, 'x', patton::arena_allocator<char>(arena));
+        if (large.back() != 'x') allocationsAreCorrect = false;
+        if (!std::all_of(v.begin(), v.end(), [&ctx](int x) { return x == ctx.thread_index(); })) allocationsAreCorrect = false;
+
+        if (arenaSize != 0)
+        {
+                // Memory which is not deallocated is released when the arena is reset.
+            [[maybe_unused]] int* leaked = patton::arena_allocator<int>(arena).allocate(10);
+        }
+    };
+    threadSquad.run(action);
+    threadSquad.run(action);
+    CHECK(arenasAreReset.load());
+    CHECK(allocationsAreCorrect.load());
+}
+
+TEST_CASE("thread_squad::for_each_index()")
+{
+    using schedule = patton::thread_squad::schedule;
+    using schedule_kind = patton::thread_squad::schedule_kind;
+
+    int numThreads = GENERATE(1, 2, 3, 8);
+    CAPTURE(numThreads);
+
+    auto sched = GENERATE(
+        schedule{ .kind = schedule_kind::static_block },
+        schedule{ .kind = schedule_kind::static_cyclic },
+        schedule{ .kind = schedule_kind::static_cyclic, .chunk_size = 3 },
+        schedule{ .kind = schedule_kind::chunked },
+        schedule{ .kind = schedule_kind::chunked, .chunk_size = 7 },
+        schedule{ .kind = schedule_kind::guided },
+        schedule{ .kind = schedule_kind::guided, .chunk_size = 4 },
+        schedule{ .kind = schedule_kind::work_stealing },
+        schedule{ .kind = schedule_kind::work_stealing, .chunk_size = 5 });
+    CAPTURE(sched.kind, sched.chunk_size);
+
+    std::ptrdiff_t first = GENERATE(0, -5, 42);
+    std::ptrdiff_t count = GENERATE(0, 1, 5, 100, 1001);
+    CAPTURE(first, count);
+
+    auto visits = std::vector<std::atomic<int>>(static_cast<std::size_t>(count));
+    auto body = [first, &visits]
+    (std::ptrdiff_t i)
+    {
+        visits[static_cast<std::size_t>(i - first)].fetch_add(1, std::memory_order_relaxed);
+    };
+
+    SECTION("reusable thread squad")
+    {
+        auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+        threadSquad.for_each_index(first, first + count, body, sched);
+        threadSquad.for_each_index(first, first + count, body, sched);
+        CHECK(std::all_of(visits.begin(), visits.end(), [](std::atomic<int> const& v) { return v.load() == 2; }));
+    }
+    SECTION("temporary thread squad")
+    {
+        patton::thread_squad({ .num_threads = numThreads }).for_each_index(first, first + count, body, sched);
+        CHECK(std::all_of(visits.begin(), visits.end(), [](std::atomic<int> const& v) { return v.load() == 1; }));
+    }
+}
+
+TEST_CASE("thread_squad::for_each_index() with work stealing balances skewed loads")
+{
+    using schedule_kind = patton::thread_squad::schedule_kind;
+
+    int numThreads = GENERATE(2, 4);
+    CAPTURE(numThreads);
+
+        // Only the indices in the initial block of thread 0 are expensive, so the other threads must steal them.
+    constexpr std::ptrdiff_t blockSize = 50;
+    std::ptrdiff_t count = blockSize*numThreads;
+    auto visits = std::vector<std::atomic<int>>(static_cast<std::size_t>(count));
+    auto heavyBlockThreads = std::vector<std::thread::id>(static_cast<std::size_t>(blockSize));
+    auto threadSquad = patton::thread_squad({ .num_threads = numThreads });
+    threadSquad.for_each_index(std::ptrdiff_t(0), count,
+        [&visits, &heavyBlockThreads]
+        (std::ptrdiff_t i)
+        {
+            visits[static_cast<std::size_t>(i)].fetch_add(1, std::memory_order_relaxed);
+            if (i < blockSize)
+            {
+                heavyBlockThreads[static_cast<std::size_t>(i)] = std::this_thread::get_id();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        },
+        { .kind = schedule_kind::work_stealing });
+    CHECK(std::all_of(visits.begin(), visits.end(), [](std::atomic<int> const& v) { return v.load() == 1; }));
+
+    std::sort(heavyBlockThreads.begin(), heavyBlockThreads.end());
+    auto numHeavyBlockThreads = std::unique(heavyBlockThreads.begin(), heavyBlockThreads.end()) - heavyBlockThreads.begin();
+    CHECK(numHeavyBlockThreads > 1);
 }